@@ -0,0 +1,154 @@
+#include "AlphaBetaEngine.h"
+
+namespace {
+	// Nodes between two clock reads
+	const uint64_t TIME_CHECK_INTERVAL = 1024;
+
+	// Proven scores are stored relative to the position (distance from it, not from the root)
+	int scoreToTable(int score, int ply)
+	{
+		if (!AlphaBetaEngine::isProvenScore(score)) return score;
+		return score > 0 ? score + ply : score - ply;
+	}
+
+	int scoreFromTable(int score, int ply)
+	{
+		if (!AlphaBetaEngine::isProvenScore(score)) return score;
+		return score > 0 ? score - ply : score + ply;
+	}
+}
+
+AlphaBetaEngine::AlphaBetaEngine(size_t ttMegabytes, std::shared_ptr<const Evaluator> evaluator)
+	: transpositionTable(ttMegabytes), evaluator(evaluator ? evaluator : std::make_shared<AdvancementEvaluator>()),
+	searchState(3), nodes(0), aborted(false), mustFinish(false)
+{
+}
+
+AlphaBetaEngine::SearchResult AlphaBetaEngine::search(const GameState& root, std::chrono::milliseconds budget, int maxDepth)
+{
+	// No game lasts longer than the total distance all tokens can travel
+	const int size = root.getSize();
+	const int longestGame = 2 * (size - 2) * (size - 1) + 1;
+	if (maxDepth <= 0 || maxDepth > longestGame) {
+		maxDepth = longestGame;
+	}
+
+	searchState = root;
+	deadline = std::chrono::steady_clock::now() + budget;
+	nodes = 0;
+	aborted = false;
+
+	SearchResult result;
+	for (int depth = 1; depth <= maxDepth; depth++) {
+		mustFinish = depth == 1;
+		GameState::CompactMove bestMove;
+		const int score = negamax(depth, -INFINITE_SCORE, INFINITE_SCORE, 0, bestMove);
+		if (aborted) {
+			break; // keep the last completed iteration
+		}
+
+		result.bestMove = bestMove.isValid() ? root.toMove(bestMove) : GameState::Move(-1, -1, -1, -1);
+		result.score = score;
+		result.depth = depth;
+		result.proven = isProvenScore(score);
+		if (result.proven) {
+			break; // deeper iterations cannot change a proven result
+		}
+	}
+	result.nodes = nodes;
+	return result;
+}
+
+int AlphaBetaEngine::negamax(int depth, int alpha, int beta, int ply, GameState::CompactMove& bestMove)
+{
+	bestMove = GameState::CompactMove();
+	nodes++;
+	if (!mustFinish && nodes % TIME_CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline) {
+		aborted = true;
+	}
+	if (aborted) {
+		return 0;
+	}
+
+	// The game is over once a player has all tokens home
+	const GameState::Player current = searchState.getCurrentPlayer();
+	const GameState::Player opponent = current == GameState::Player::PLAYER1 ? GameState::Player::PLAYER2 : GameState::Player::PLAYER1;
+	if (searchState.isWinningForPlayer(current)) {
+		return WIN_SCORE - ply;
+	}
+	if (searchState.isWinningForPlayer(opponent)) {
+		return -(WIN_SCORE - ply);
+	}
+
+	// Transposition table: cut off on a deep enough bound, otherwise try its move first
+	const uint64_t key = searchState.getZobristKey();
+	GameState::CompactMove tableMove;
+	uint64_t data;
+	if (transpositionTable.probe(key, data)) {
+		const Bound bound = static_cast<Bound>(data & 0x3);
+		tableMove = GameState::CompactMove::fromBits(static_cast<uint16_t>(data >> 2));
+		const int score = scoreFromTable(static_cast<int16_t>(static_cast<uint16_t>(data >> 18)), ply);
+		const int entryDepth = static_cast<int>(TranspositionTable::priorityOf(data));
+		if (ply > 0 && entryDepth >= depth) {
+			if (bound == Bound::EXACT ||
+				(bound == Bound::LOWER && score >= beta) ||
+				(bound == Bound::UPPER && score <= alpha)) {
+				bestMove = tableMove;
+				return score;
+			}
+		}
+	}
+
+	if (depth == 0) {
+		return evaluator->evaluate(searchState);
+	}
+
+	GameState::MoveList moves;
+	searchState.generateAllPossibleMoves(moves);
+	if (moves.empty()) {
+		return -(WIN_SCORE - ply); // no move left loses
+	}
+
+	// Search the table move first (only when it is legal here, keys can collide)
+	int order[GameState::MAX_MOVES];
+	for (int i = 0; i < moves.size(); i++) {
+		order[i] = i;
+	}
+	for (int i = 1; i < moves.size(); i++) {
+		if (moves[order[i]] == tableMove) {
+			std::swap(order[0], order[i]);
+			break;
+		}
+	}
+
+	const int originalAlpha = alpha;
+	int bestScore = -INFINITE_SCORE;
+	for (int i = 0; i < moves.size(); i++) {
+		const GameState::CompactMove move = moves[order[i]];
+		GameState::UndoInfo undo = searchState.makeMove(move);
+		GameState::CompactMove childBest;
+		const int score = -negamax(depth - 1, -beta, -alpha, ply + 1, childBest);
+		searchState.unmakeMove(move, undo);
+		if (aborted) {
+			return 0;
+		}
+
+		if (score > bestScore) {
+			bestScore = score;
+			bestMove = move;
+			if (score > alpha) alpha = score;
+			if (alpha >= beta) break;
+		}
+	}
+
+	const Bound bound = bestScore <= originalAlpha ? Bound::UPPER : bestScore >= beta ? Bound::LOWER : Bound::EXACT;
+	transpositionTable.store(key, makeData(bound, bestMove, scoreToTable(bestScore, ply), depth));
+	return bestScore;
+}
+
+uint64_t AlphaBetaEngine::makeData(Bound bound, GameState::CompactMove move, int score, int depth)
+{
+	return static_cast<uint64_t>(bound) | (static_cast<uint64_t>(move.bits) << 2) |
+		(static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(score))) << 18) |
+		(static_cast<uint64_t>(depth) << 48);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include "GameState.h"
+#include "Evaluator.h"
+#include "TranspositionTable.h"
+
+// Depth-limited negamax with alpha-beta pruning and iterative deepening, for boards too large
+// for the exhaustive solvers. Each iteration searches one ply deeper until the time budget runs out,
+// the best move of the last completed iteration is returned.
+// Positions are cached in a TranspositionTable keyed by the Zobrist key, with its own payload:
+// bits 0-1 bound type, bits 2-17 best move, bits 18-33 score, bits 48-63 depth (replacement priority).
+class AlphaBetaEngine
+{
+public:
+	// Proven results: a win reached at ply p scores WIN_SCORE - p, so shorter wins score higher
+	static const int WIN_SCORE = 30000;
+	static const int INFINITE_SCORE = 32000;
+	static const size_t DEFAULT_TT_MEGABYTES = 32;
+
+	struct SearchResult
+	{
+		GameState::Move bestMove;
+		int score = 0;       // from the point of view of the side to move
+		int depth = 0;       // last completed iteration
+		uint64_t nodes = 0;
+		bool proven = false; // score is a proven win or loss
+	};
+
+	// evaluator nullptr uses AdvancementEvaluator with the default weights
+	explicit AlphaBetaEngine(size_t ttMegabytes = DEFAULT_TT_MEGABYTES, std::shared_ptr<const Evaluator> evaluator = nullptr);
+
+	// Best move for the side to move within the time budget (at least one iteration is completed)
+	SearchResult search(const GameState& root, std::chrono::milliseconds budget, int maxDepth = 0);
+
+	static bool isProvenScore(int score) { return score >= WIN_SCORE - MAX_PLY || score <= -(WIN_SCORE - MAX_PLY); }
+
+private:
+	static const int MAX_PLY = 256;
+	enum class Bound { EXACT = 1, LOWER = 2, UPPER = 3 };
+
+	TranspositionTable transpositionTable;
+	std::shared_ptr<const Evaluator> evaluator;
+
+	GameState searchState;
+	std::chrono::steady_clock::time_point deadline;
+	uint64_t nodes;
+	bool aborted;
+	bool mustFinish; // the first iteration ignores the deadline
+
+	int negamax(int depth, int alpha, int beta, int ply, GameState::CompactMove& bestMove);
+
+	static uint64_t makeData(Bound bound, GameState::CompactMove move, int score, int depth);
+};
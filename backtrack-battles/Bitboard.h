@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Largest board the bitboard representation can hold (10x10 = 100 cells out of 128 bits)
+const int MAX_BOARD_SIZE = 10;
+
+// Portable bit helpers (MSVC intrinsics on x64, GCC/Clang builtins elsewhere)
+inline int countBits(uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return static_cast<int>(__popcnt64(value));
+#elif defined(__GNUC__)
+	return __builtin_popcountll(value);
+#else
+	int count = 0;
+	while (value) { value &= value - 1; count++; }
+	return count;
+#endif
+}
+
+// Index of the lowest set bit, value must not be zero
+inline int lowestBitIndex(uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<int>(index);
+#elif defined(__GNUC__)
+	return __builtin_ctzll(value);
+#else
+	int index = 0;
+	while (!(value & 1)) { value >>= 1; index++; }
+	return index;
+#endif
+}
+
+// 128-bit occupancy mask split in two 64-bit words
+// cell (row, col) of an N x N board lives at bit index row * N + col
+struct Bitboard
+{
+	uint64_t low;  // bits 0..63
+	uint64_t high; // bits 64..127
+
+	constexpr Bitboard() : low(0), high(0) {}
+	constexpr Bitboard(uint64_t low, uint64_t high) : low(low), high(high) {}
+
+	// Mask with a single cell set
+	static constexpr Bitboard cell(int index)
+	{
+		return index < 64 ? Bitboard(uint64_t(1) << index, 0) : Bitboard(0, uint64_t(1) << (index - 64));
+	}
+
+	bool test(int index) const
+	{
+		return index < 64 ? (low >> index) & 1 : (high >> (index - 64)) & 1;
+	}
+
+	void set(int index) { *this = *this | cell(index); }
+	void clear(int index) { *this = *this & ~cell(index); }
+
+	bool isEmpty() const { return (low | high) == 0; }
+	int popCount() const { return countBits(low) + countBits(high); }
+
+	// Removes the lowest set cell and returns its index, mask must not be empty
+	int popLowest()
+	{
+		if (low) {
+			int index = lowestBitIndex(low);
+			low &= low - 1;
+			return index;
+		}
+		int index = 64 + lowestBitIndex(high);
+		high &= high - 1;
+		return index;
+	}
+
+	// Shift towards higher cell indices (down a row for shift == N, right a column for shift == 1)
+	constexpr Bitboard operator<<(int shift) const
+	{
+		if (shift == 0) return *this;
+		if (shift >= 64) return Bitboard(0, low << (shift - 64));
+		return Bitboard(low << shift, (high << shift) | (low >> (64 - shift)));
+	}
+
+	constexpr Bitboard operator>>(int shift) const
+	{
+		if (shift == 0) return *this;
+		if (shift >= 64) return Bitboard(high >> (shift - 64), 0);
+		return Bitboard((low >> shift) | (high << (64 - shift)), high >> shift);
+	}
+
+	constexpr Bitboard operator&(const Bitboard& other) const { return Bitboard(low & other.low, high & other.high); }
+	constexpr Bitboard operator|(const Bitboard& other) const { return Bitboard(low | other.low, high | other.high); }
+	constexpr Bitboard operator^(const Bitboard& other) const { return Bitboard(low ^ other.low, high ^ other.high); }
+	constexpr Bitboard operator~() const { return Bitboard(~low, ~high); }
+
+	constexpr bool operator==(const Bitboard& other) const { return low == other.low && high == other.high; }
+	constexpr bool operator!=(const Bitboard& other) const { return !(*this == other); }
+};
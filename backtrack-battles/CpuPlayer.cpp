@@ -0,0 +1,132 @@
+#include "CpuPlayer.h"
+#include "AlphaBetaEngine.h"
+#include "GameSolver.h"
+#include "Tablebase.h"
+#include <climits>
+
+GameState::Move CpuPlayer::chooseMove(const GameState& state)
+{
+	GameState::Move bestMove(-1, -1, -1, -1);
+
+	if (const MappedTablebase* table = tablebaseFor(state.getSize())) {
+		bestMove = tablebaseMove(*table, state);
+	}
+	else if (state.getSize() <= SEARCH_FALLBACK_MAX_SIZE) {
+		bestMove = searchMove(state);
+	}
+	else {
+		bestMove = engineMove(state);
+	}
+
+	// No tablebase verdict (lost with a WIN_LOSS file): keep making progress
+	if (bestMove.fromRow == -1) {
+		bestMove = heuristicMove(state);
+	}
+	return bestMove;
+}
+
+std::string CpuPlayer::tablebasePath(int size)
+{
+	return "tablebase-" + std::to_string(size) + ".bin";
+}
+
+const MappedTablebase* CpuPlayer::tablebaseFor(int size)
+{
+	static std::unique_ptr<MappedTablebase> tables[Tablebase::MAX_TABLEBASE_SIZE + 1];
+	static bool opened[Tablebase::MAX_TABLEBASE_SIZE + 1] = {};
+
+	if (size < 3 || size > Tablebase::MAX_TABLEBASE_SIZE) {
+		return nullptr;
+	}
+	// Mapped lazily so startup never waits for (or needs) the files
+	if (!opened[size]) {
+		opened[size] = true;
+		tables[size] = MappedTablebase::open(tablebasePath(size));
+		if (tables[size] && tables[size]->getSize() != size) {
+			tables[size].reset();
+		}
+	}
+	return tables[size].get();
+}
+
+GameState::Move CpuPlayer::tablebaseMove(const MappedTablebase& table, const GameState& state)
+{
+	GameState::MoveList moves;
+	state.generateAllPossibleMoves(moves);
+
+	GameState::CompactMove winMove;
+	int winDistance = -1;
+	GameState::CompactMove longestMove;
+	int longestDistance = -1;
+	for (const GameState::CompactMove& move : moves) {
+		GameState child = state;
+		child.makeMove(move);
+		const uint64_t index = Tablebase::rank(child);
+
+		if (!table.hasDistance()) {
+			if (!table.isWin(index)) {
+				return state.toMove(move); // the opponent is in a bad state
+			}
+			continue;
+		}
+
+		const int distance = table.distance(index);
+		if (!table.isWin(index)) {
+			if (winDistance < 0 || distance < winDistance) {
+				winMove = move;
+				winDistance = distance;
+			}
+		}
+		else if (distance > longestDistance) {
+			longestMove = move;
+			longestDistance = distance;
+		}
+	}
+
+	if (winMove.isValid()) return state.toMove(winMove);
+	if (longestMove.isValid()) return state.toMove(longestMove);
+	return GameState::Move(-1, -1, -1, -1);
+}
+
+GameState::Move CpuPlayer::searchMove(const GameState& state)
+{
+	GameSolver solver(state, SEARCH_TABLE_MEGABYTES);
+	solver.setExactDistance(true);
+	solver.solve();
+	return solver.getBestMove().second;
+}
+
+GameState::Move CpuPlayer::engineMove(const GameState& state)
+{
+	// One engine for the whole program so its transposition table carries over between moves
+	static AlphaBetaEngine engine;
+	return engine.search(state, std::chrono::milliseconds(ENGINE_TIME_BUDGET_MS)).bestMove;
+}
+
+GameState::Move CpuPlayer::heuristicMove(const GameState& state)
+{
+	GameState::Move bestMove(-1, -1, -1, -1);
+	int highestPriority = INT_MIN;
+
+	// Simple heuristic: prioritize most progressive moves
+	for (const GameState::Move& move : state.generateAllPossibleMoves()) {
+		int priority = calculateMovePriority(state, move);
+		if (priority > highestPriority) {
+			highestPriority = priority;
+			bestMove = move;
+		}
+	}
+	return bestMove;
+}
+
+int CpuPlayer::calculateMovePriority(const GameState& state, const GameState::Move& move)
+{
+	// Reward vertical progress for Player 1 (CPU)
+	if (state.getCurrentPlayer() == GameState::Player::PLAYER1) {
+		return (move.toRow - move.fromRow) * 2; // Prioritize bigger jumps
+	}
+	// Reward horizontal progress for Player 2
+	else {
+		return (move.toCol - move.fromCol) * 2;
+	}
+}
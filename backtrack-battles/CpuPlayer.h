@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include "GameState.h"
+#include "MappedTablebase.h"
+
+// Move selection for the computer player, shared by the GUI and the terminal version.
+// In order of preference:
+//   1. the tablebase file of the board size (tablebase-N.bin in the working directory),
+//      mapped on first use, a probe per legal move gives a perfect move at once
+//   2. an exact GameSolver search on boards small enough to solve between two moves
+//   3. an AlphaBetaEngine search under a time budget on larger boards
+// With distances (DISTANCE tablebases, search) the CPU takes the shortest win and, when lost,
+// the move that holds out longest.
+class CpuPlayer
+{
+public:
+	// Largest board solved by search when no tablebase covers it
+	static const int SEARCH_FALLBACK_MAX_SIZE = 6;
+	static const size_t SEARCH_TABLE_MEGABYTES = 16;
+	// Thinking time per move on boards handled by the alpha-beta engine
+	static const int ENGINE_TIME_BUDGET_MS = 500;
+
+	// Best move for the side to move, an invalid move (fromRow == -1) when there is none
+	static GameState::Move chooseMove(const GameState& state);
+
+	static std::string tablebasePath(int size);
+
+private:
+	// Mapped tablebase for the size, nullptr when there is no usable file (checked once per size)
+	static const MappedTablebase* tablebaseFor(int size);
+
+	// Shortest win, or longest resistance with a DISTANCE file (WIN_LOSS files give any win and
+	// an invalid move when every move loses)
+	static GameState::Move tablebaseMove(const MappedTablebase& table, const GameState& state);
+	static GameState::Move searchMove(const GameState& state);
+	static GameState::Move engineMove(const GameState& state);
+	static GameState::Move heuristicMove(const GameState& state);
+	static int calculateMovePriority(const GameState& state, const GameState::Move& move);
+};
@@ -0,0 +1,201 @@
+#include "DfpnSolver.h"
+#include <algorithm>
+#include "Evaluator.h"
+
+namespace {
+	// Evaluation points per unit of initial proof number (half a cell of the race)
+	const int EVALUATION_SCALE = 5;
+
+	uint32_t saturatedAdd(uint32_t a, uint32_t b, uint32_t limit)
+	{
+		return a >= limit - b ? limit : a + b;
+	}
+}
+
+DfpnSolver::DfpnSolver(const GameState& initialState, size_t ttMegabytes) : ownedTable(new TranspositionTable(ttMegabytes)),
+	transpositionTable(*ownedTable), initialState(initialState), searchState(initialState), rootBestMove(-1, -1, -1, -1),
+	rootSolved(false), rootIsGood(false), rootDistance(0), nodesExpanded(0), reExpansions(0), cancelled(false)
+{
+}
+
+DfpnSolver::DfpnSolver(const GameState& initialState, TranspositionTable& sharedTable) : transpositionTable(sharedTable),
+	initialState(initialState), searchState(initialState), rootBestMove(-1, -1, -1, -1), rootSolved(false),
+	rootIsGood(false), rootDistance(0), nodesExpanded(0), reExpansions(0), cancelled(false)
+{
+}
+
+void DfpnSolver::setCancelCheck(std::function<bool()> check)
+{
+	cancelCheck = std::move(check);
+}
+
+bool DfpnSolver::solve()
+{
+	searchState = initialState;
+	cancelled = false;
+
+	// Infinite thresholds: search returns only once the root is proven (or cancelled)
+	const Numbers root = search(INFINITE, INFINITE);
+	if (cancelled || !root.isProven()) {
+		return false;
+	}
+
+	rootSolved = true;
+	rootIsGood = root.proof == 0;
+	rootDistance = root.distance;
+	if (root.bestMove.isValid()) {
+		rootBestMove = initialState.toMove(root.bestMove);
+	}
+	return rootIsGood;
+}
+
+std::pair<GameState, GameState::Move> DfpnSolver::getBestMove() const
+{
+	return { initialState, rootBestMove };
+}
+
+DfpnSolver::Numbers DfpnSolver::lookup()
+{
+	bool transposed;
+	uint64_t data;
+	if (transpositionTable.probe(GameSolver::canonicalKey(searchState, transposed), data)) {
+		const TranspositionTable::Result result = TranspositionTable::resultOf(data);
+		if (result == TranspositionTable::Result::UNKNOWN) {
+			return { TranspositionTable::proofOf(data), TranspositionTable::disproofOf(data), 0, GameState::CompactMove(), true };
+		}
+		const GameState::CompactMove stored = GameState::CompactMove::fromBits(TranspositionTable::moveOf(data));
+		const GameState::CompactMove move = GameSolver::fromStoredMove(searchState, stored, transposed);
+		if (result == TranspositionTable::Result::WIN) {
+			return { 0, INFINITE, TranspositionTable::distanceOf(data), move, true };
+		}
+		return { INFINITE, 0, TranspositionTable::distanceOf(data), move, true };
+	}
+
+	// Same terminal rule as GameSolver: the side to move has already won
+	if (searchState.isWinningForPlayer(searchState.getCurrentPlayer())) {
+		return { 0, INFINITE, 0, GameState::CompactMove(), false };
+	}
+	if (searchState.isDisengaged()) {
+		int distance;
+		const GameState::CompactMove step = searchState.firstRetiredStep();
+		if (GameSolver::raceResult(searchState, distance)) {
+			return { 0, INFINITE, distance, step, false };
+		}
+		return { INFINITE, 0, distance, step, false };
+	}
+	// New position: the side ahead in the race is cheaper to prove than to disprove
+	static const AdvancementEvaluator evaluator;
+	const int advantage = evaluator.evaluate(searchState) / EVALUATION_SCALE;
+	const uint32_t proof = 1 + (advantage < 0 ? -advantage : 0);
+	const uint32_t disproof = 1 + (advantage > 0 ? advantage : 0);
+	return { proof, disproof, 0, GameState::CompactMove(), false };
+}
+
+DfpnSolver::Numbers DfpnSolver::search(uint32_t proofThreshold, uint32_t disproofThreshold)
+{
+	Numbers numbers = lookup();
+	if (numbers.isProven() || numbers.proof >= proofThreshold || numbers.disproof >= disproofThreshold) {
+		return numbers;
+	}
+	if (numbers.expanded) {
+		reExpansions++;
+	}
+
+	const uint64_t nodesAtEntry = nodesExpanded++;
+	if (cancelCheck && nodesExpanded % GameSolver::CANCEL_POLL_INTERVAL == 0 && cancelCheck()) {
+		cancelled = true;
+	}
+	if (cancelled) {
+		return numbers;
+	}
+	numbers.expanded = true;
+
+	GameState::MoveList moves;
+	searchState.generateAllPossibleMoves(moves);
+	if (moves.empty()) {
+		numbers = { INFINITE, 0, 0, GameState::CompactMove(), true }; // no move left loses
+		store(numbers, 0);
+		return numbers;
+	}
+
+	// Numbers of the children, kept up to date as they are searched
+	Numbers children[GameState::MAX_MOVES];
+	for (int i = 0; i < moves.size(); i++) {
+		GameState::UndoInfo undo = searchState.makeMove(moves[i]);
+		children[i] = lookup();
+		searchState.unmakeMove(moves[i], undo);
+	}
+
+	while (true) {
+		// The side to move wins through any lost child (proof = smallest child disproof)
+		// and loses only when every child is won for the opponent (disproof = sum of child proofs)
+		int best = -1;
+		uint32_t secondDisproof = INFINITE;
+		numbers.disproof = 0;
+		for (int i = 0; i < moves.size(); i++) {
+			const Numbers& child = children[i];
+			numbers.disproof = saturatedAdd(numbers.disproof, child.proof, INFINITE);
+			if (best < 0 || child.disproof < children[best].disproof) {
+				if (best >= 0) secondDisproof = children[best].disproof;
+				best = i;
+			}
+			else if (child.disproof < secondDisproof) {
+				secondDisproof = child.disproof;
+			}
+		}
+		numbers.proof = children[best].disproof;
+		// A saturated sum must not read as the infinite disproof of a proven win
+		if (numbers.proof != 0 && numbers.disproof == INFINITE) {
+			numbers.disproof = INFINITE - 1;
+		}
+
+		if (numbers.proof == 0) {
+			// Won: the lost child found, distance along it
+			numbers.disproof = INFINITE;
+			numbers.bestMove = moves[best];
+			numbers.distance = children[best].distance + 1;
+			break;
+		}
+		if (numbers.disproof == 0) {
+			// Lost: every child is won for the opponent, hold out along the longest one
+			numbers.proof = INFINITE;
+			numbers.distance = 0;
+			for (int i = 0; i < moves.size(); i++) {
+				if (children[i].distance + 1 > numbers.distance) {
+					numbers.distance = children[i].distance + 1;
+					numbers.bestMove = moves[i];
+				}
+			}
+			break;
+		}
+		if (numbers.proof >= proofThreshold || numbers.disproof >= disproofThreshold || cancelled) {
+			break;
+		}
+
+		// Descend into the child with the smallest disproof number: its disproof threshold stops it
+		// once a sibling becomes cheaper, its proof threshold once this position exceeds its own
+		// (1 + epsilon trick: a margin of a quarter above the sibling avoids switching back and forth between close children)
+		const uint32_t margin = secondDisproof / 4 + 1;
+		const uint32_t childDisproofThreshold = std::min(proofThreshold, saturatedAdd(secondDisproof, margin, INFINITE));
+		const uint32_t childProofThreshold = saturatedAdd(disproofThreshold - numbers.disproof, children[best].proof, INFINITE);
+		GameState::UndoInfo undo = searchState.makeMove(moves[best]);
+		children[best] = search(childProofThreshold, childDisproofThreshold);
+		searchState.unmakeMove(moves[best], undo);
+	}
+
+	store(numbers, nodesExpanded - nodesAtEntry);
+	return numbers;
+}
+
+void DfpnSolver::store(const Numbers& numbers, uint64_t priority)
+{
+	bool transposed;
+	const uint64_t key = GameSolver::canonicalKey(searchState, transposed);
+	if (!numbers.isProven()) {
+		transpositionTable.store(key, TranspositionTable::makeProofData(numbers.proof, numbers.disproof, priority));
+		return;
+	}
+	const TranspositionTable::Result result = numbers.proof == 0 ? TranspositionTable::Result::WIN : TranspositionTable::Result::LOSS;
+	const GameState::CompactMove stored = GameSolver::toStoredMove(searchState, numbers.bestMove, transposed);
+	transpositionTable.store(key, TranspositionTable::makeData(result, stored.bits, numbers.distance, priority));
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <utility>
+#include "GameState.h"
+#include "GameSolver.h"
+#include "TranspositionTable.h"
+
+// Depth-first proof-number search. Every position carries a proof number (how many positions
+// still have to be won to prove a win for the side to move) and a disproof number (the same for a
+// loss); the search always descends into the child that is cheapest to settle, under thresholds
+// that send it back up as soon as a sibling becomes cheaper.
+// Proven positions are stored in the TranspositionTable exactly as GameSolver stores them (same
+// canonical keys, moves and results), unproven ones as UNKNOWN entries holding both numbers,
+// so a table can be shared with or handed over to the other solvers.
+// The game has no cycles (every move advances a token), so there is no graph history problem.
+class DfpnSolver
+{
+public:
+	explicit DfpnSolver(const GameState& initialState, size_t ttMegabytes = GameSolver::DEFAULT_TT_MEGABYTES);
+	DfpnSolver(const GameState& initialState, TranspositionTable& sharedTable);
+
+	// Install a check polled every GameSolver::CANCEL_POLL_INTERVAL expansions, solve stops when it returns true
+	void setCancelCheck(std::function<bool()> check);
+
+	// Main solving function, true when the side to move wins
+	bool solve();
+
+	// Winning move when the root is won, the move holding out longest when it is lost
+	std::pair<GameState, GameState::Move> getBestMove() const;
+
+	// Plies until the game ends along the proof found (not necessarily the shortest win)
+	int getDistance() const { return rootDistance; }
+
+	bool hasWinningStrategy() const { return rootSolved && rootIsGood; }
+
+	// False until solve finished without being cancelled
+	bool isSolved() const { return rootSolved; }
+
+	// Positions whose children were generated, and how often a position was searched again
+	uint64_t getNodesExpanded() const { return nodesExpanded; }
+	uint64_t getReExpansions() const { return reExpansions; }
+
+	TranspositionTable::Counters getTableCounters() const { return transpositionTable.getCounters(); }
+
+private:
+	static const uint32_t INFINITE = TranspositionTable::MAX_PROOF_NUMBER;
+
+	// Proof state of a position, for its side to move
+	struct Numbers
+	{
+		uint32_t proof;
+		uint32_t disproof;
+		int distance; // plies to the end of the game once proven
+		GameState::CompactMove bestMove;
+		bool expanded; // searched before (the numbers come from the table)
+
+		bool isProven() const { return proof == 0 || disproof == 0; }
+	};
+
+	std::unique_ptr<TranspositionTable> ownedTable;
+	TranspositionTable& transpositionTable;
+
+	GameState initialState;
+	GameState searchState; // mutated in place with makeMove/unmakeMove
+	GameState::Move rootBestMove;
+	bool rootSolved;
+	bool rootIsGood;
+	int rootDistance;
+
+	uint64_t nodesExpanded;
+	uint64_t reExpansions;
+	std::function<bool()> cancelCheck;
+	bool cancelled;
+
+	// Current numbers of searchState: the table entry, a terminal result, or initial numbers
+	// from AdvancementEvaluator for a new position
+	Numbers lookup();
+
+	// Search searchState until its proof number reaches proofThreshold or its disproof number
+	// reaches disproofThreshold (or it is proven), returns its numbers at that point
+	Numbers search(uint32_t proofThreshold, uint32_t disproofThreshold);
+
+	void store(const Numbers& numbers, uint64_t priority);
+};
@@ -0,0 +1,57 @@
+#include "Evaluator.h"
+
+namespace {
+	// Per player terms of the evaluation
+	struct SideTerms
+	{
+		int remaining = 0; // cells left to travel
+		int blocked = 0;
+		int jumps = 0;
+	};
+
+	// Player 1 tokens move down their column lane + 1, Player 2 tokens right along row lane + 1,
+	// a token sits in front of an opponent exactly when the opponent occupies the next cell of its lane
+	SideTerms sideTerms(const PackedState& packed, int size, bool player2)
+	{
+		const int lanes = size - 2;
+		const int last = size - 1;
+		auto position = [&](bool ofPlayer2, int lane) {
+			return ofPlayer2 ? packed.getPlayer2Lane(lanes, lane) : packed.getPlayer1Lane(lane);
+		};
+		// Opponent token on cell `along` of the lane with index `lane`
+		auto opponentAt = [&](int lane, int along) {
+			if (along < 1 || along > size - 2) return false;
+			return position(!player2, along - 1) == lane + 1;
+		};
+
+		SideTerms terms;
+		for (int lane = 0; lane < lanes; lane++) {
+			const int from = position(player2, lane);
+			terms.remaining += last - from;
+			if (from >= last) continue;
+
+			if (opponentAt(lane, from + 1)) {
+				if (from + 2 <= last && !opponentAt(lane, from + 2)) {
+					terms.jumps++;
+				}
+				else {
+					terms.blocked++;
+				}
+			}
+		}
+		return terms;
+	}
+}
+
+int AdvancementEvaluator::evaluate(const GameState& state) const
+{
+	const PackedState packed = state.toPackedState();
+	const bool player2ToMove = state.getCurrentPlayer() == GameState::Player::PLAYER2;
+	const SideTerms own = sideTerms(packed, state.getSize(), player2ToMove);
+	const SideTerms opponent = sideTerms(packed, state.getSize(), !player2ToMove);
+
+	return weights.advancement * (opponent.remaining - own.remaining)
+		+ weights.blockedLane * (opponent.blocked - own.blocked)
+		+ weights.pendingJump * (own.jumps - opponent.jumps)
+		+ weights.tempo;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "GameState.h"
+
+// Static evaluation for the depth-limited search (AlphaBetaEngine).
+// Scores are from the point of view of the side to move: positive is good for it.
+// They must stay well inside +-AlphaBetaEngine::WIN_SCORE, which is reserved for proven results.
+class Evaluator
+{
+public:
+	virtual ~Evaluator() = default;
+	virtual int evaluate(const GameState& state) const = 0;
+};
+
+// Default evaluator: a race between the two players' remaining distances, corrected for
+// tokens that cannot move right now (blocked lanes) and jumps that are available (pending jumps)
+class AdvancementEvaluator : public Evaluator
+{
+public:
+	struct Weights
+	{
+		int advancement = 10; // per cell of remaining distance (opponent's minus own)
+		int blockedLane = 4;  // per token that can neither step nor jump
+		int pendingJump = 6;  // per jump available (a jump gains two cells in one move)
+		int tempo = 5;        // having the move in a race is worth about half a step
+	};
+
+	AdvancementEvaluator() = default;
+	explicit AdvancementEvaluator(const Weights& weights) : weights(weights) {}
+
+	int evaluate(const GameState& state) const override;
+
+private:
+	Weights weights;
+};
@@ -1,21 +1,28 @@
 #include "GameSolver.h"
-#include <iostream>
+#include <cstdint>
+#include "Trace.h"
 
 // this function is replaced by the processNextFrame function to meet the requirement
 // of the stack-based backtracking for dfs in the project requirements on the e-learning
-bool GameSolver::isGoodState(const GameState& state)
+bool GameSolver::isGoodState(const GameState& state, int& distance)
 {
-	std::cerr << "Evaluating state:\n" << state.toString() << "\n";
+	TRACE(Verbose, "Evaluating state {x} {x} (size {})", state.toPackedState().low, state.toPackedState().high, state.getSize());
+	bool transposed;
+	const uint64_t key = canonicalKey(state, transposed);
+	uint64_t data;
 	// Check memoization cache first
-	if (memoizationCache.find(state) != memoizationCache.end())
+	if (transpositionTable.probe(key, data) && TranspositionTable::resultOf(data) != TranspositionTable::Result::UNKNOWN)
 	{
-		currentBestMove.second = memoizationCache[state].bestMove;
-		return memoizationCache[state].isGood;
+		GameState::CompactMove stored = GameState::CompactMove::fromBits(TranspositionTable::moveOf(data));
+		currentBestMove.second = state.toMove(fromStoredMove(state, stored, transposed));
+		distance = TranspositionTable::distanceOf(data);
+		return TranspositionTable::resultOf(data) == TranspositionTable::Result::WIN;
 	}
 
 	// Base case: current Player has already won
+	distance = 0;
 	if (state.isWinningForPlayer(state.getCurrentPlayer())) {
-		memoizationCache[state] = { true, GameState::Move(-1, -1, -1, -1) }; // No move needed
+		transpositionTable.store(key, TranspositionTable::makeData(TranspositionTable::Result::WIN, GameState::CompactMove::NONE, 0, 0)); // No move needed
 		return true;
 	}
 
@@ -23,34 +30,41 @@ bool GameSolver::isGoodState(const GameState& state)
 	// used auto to avoid writing the full type whic is std::vector<GameState>
 	auto moves = state.generateAllPossibleMoves();
 	bool isGood = false;
-	GameState::Move bestMove(-1, -1, -1, -1); // Initialize bestMove
+	GameState::CompactMove longestMove; // move holding out longest if every move loses
 
 	// Check if there are no moves available (not necessary because the base case is already checked but for safety)
 	if (moves.empty()) {
-		memoizationCache[state] = { false, GameState::Move(-1, -1, -1, -1) }; // No moves available
+		transpositionTable.store(key, TranspositionTable::makeData(TranspositionTable::Result::LOSS, GameState::CompactMove::NONE, 0, 0)); // No moves available
 		return false;
 	}
 
 	// Recurisively check each move
 	for (const auto& move : moves) {
-		std::cerr << state.toString() << "\n";
+		TRACE(Verbose, "Trying move ({},{}) to ({},{})", move.fromRow, move.fromCol, move.toRow, move.toCol);
 		GameState nextState = state.applyMove(move);
 
 		// recursively check if the opponent is in a bad state
-		bool opponentIsGood = isGoodState(nextState);
+		int childDistance;
+		bool opponentIsGood = isGoodState(nextState, childDistance);
 
 		if (!opponentIsGood) {
 			// If the opponent is in a bad state, we have a winning move
-			memoizationCache[state] = { true, move };
+			GameState::CompactMove stored = toStoredMove(state, state.toCompactMove(move), transposed);
+			distance = childDistance + 1;
+			transpositionTable.store(key, TranspositionTable::makeData(TranspositionTable::Result::WIN, stored.bits, distance, 0));
 			currentBestMove = { state, move };
 			isGood = true;
 			break; // No need to check further moves
 		}
+		if (childDistance + 1 > distance) {
+			distance = childDistance + 1;
+			longestMove = toStoredMove(state, state.toCompactMove(move), transposed);
+		}
 	}
 
 	// if all moves lead to good states for the opponent, we are in a bad state
 	if (!isGood) {
-		memoizationCache[state] = { false, GameState::Move(-1, -1, -1, -1) }; // No winning move found
+		transpositionTable.store(key, TranspositionTable::makeData(TranspositionTable::Result::LOSS, longestMove.bits, distance, 0)); // No winning move found
 	}
 
 	return isGood;
@@ -62,87 +76,301 @@ bool GameSolver::processNextFrame()
 
 	StackFrame& frame = stateStack.top();
 
+	// A solved frame hands its result to the parent directly (it may already be evicted from the table)
 	if (frame.evaluated) {
-		stateStack.pop();
+		const bool childIsGood = frame.isGood;
+		const int childDistance = frame.distance;
+		const GameState::CompactMove childMove = frame.move;
+		if (frame.isRoot()) {
+			rootSolved = true;
+			rootIsGood = frame.isGood;
+			rootDistance = frame.distance;
+			if (frame.bestMove.isValid()) {
+				currentBestMove.second = searchState.toMove(frame.bestMove);
+			}
+		}
+		popFrame();
+
+		if (!stateStack.isEmpty()) {
+			recordChild(stateStack.top(), childMove, childIsGood, childDistance);
+		}
 		return true;
 	}
 
-	// Check memoization using dynamic board state
-	auto memoIt = memoizationCache.find(frame.state);
-	if (memoIt != memoizationCache.end()) {
-		currentBestMove.second = memoIt->second.bestMove;
-		stateStack.pop();
-		return true;
+	if (!frame.childrenProbed) {
+		probeChildren(frame);
+		if (frame.evaluated) return true;
 	}
 
-	// Dynamic win condition check
-	const int currentSize = frame.state.getSize();
-	if (frame.state.isWinningForPlayer(frame.state.getCurrentPlayer())) {
-		memoizationCache[frame.state] = { true, GameState::Move(-1,-1,-1,-1) };
-		currentBestMove = { frame.state, GameState::Move(-1,-1,-1,-1) };
-		stateStack.pop();
+	// Try the remaining moves: children already in the table are consumed on the spot,
+	// the first unknown child gets its own frame
+	while (frame.moveIndex < frame.moves.size()) {
+		const int index = frame.moveIndex++;
+		const GameState::CompactMove move = frame.moves[index];
+
+		// A child unknown when the frame was opened may have been solved since through another path
+		// (entries still being proven by a DfpnSolver sharing the table are not results)
+		uint64_t data = frame.childData[index];
+		if (data == RECORDED_CHILD) continue;
+		if (data == 0) {
+			const bool hit = transpositionTable.probe(frame.childKeys[index], data) &&
+				TranspositionTable::resultOf(data) != TranspositionTable::Result::UNKNOWN;
+			stats.countProbe(hit);
+			if (!hit) data = 0;
+		}
+		if (data != 0) {
+			recordChild(frame, move, TranspositionTable::resultOf(data) == TranspositionTable::Result::WIN,
+				TranspositionTable::distanceOf(data));
+			if (frame.evaluated) return true;
+			continue;
+		}
+
+		GameState::UndoInfo undo = searchState.makeMove(move);
+		pushFrame(move, undo);
 		return true;
 	}
 
-	// Process moves using board size-agnostic generation
-	if (frame.moveIndex < frame.moves.size()) {
-		GameState::Move move = frame.moves[frame.moveIndex++];
-		GameState nextState = frame.state.applyMove(move);
-		stateStack.push(StackFrame(nextState, nextState.generateAllPossibleMoves()));
-		return true;
+	if (frame.winDistance >= 0) {
+		// shortest of the winning moves (exact distance mode)
+		resolveFrame(frame, true, frame.winMove, frame.winDistance);
+	}
+	else {
+		// all moves lead to good states for the opponent, we are in a bad state: hold out as long as possible
+		resolveFrame(frame, false, frame.longestMove, frame.longestDistance < 0 ? 0 : frame.longestDistance);
 	}
+	return true;
+}
 
-	// Evaluate all possible moves dynamically
-	bool isGood = false;
-	GameState::Move bestMove(-1, -1, -1, -1);
-
-	// Check all possible subsequent states
-	for (const auto& move : frame.moves) {
-		GameState nextState = frame.state.applyMove(move);
-		auto it = memoizationCache.find(nextState);
-
-		// Size-agnostic win potential check
-		if (it != memoizationCache.end()) {
-			if (!it->second.isGood) {
-				isGood = true;
-				bestMove = move;
-				break;
-			}
+// Enhanced transposition cutoff: before expanding any child, look every child up (all buckets
+// prefetched first, then probed) and resolve the frame at once if one is already lost for the opponent
+void GameSolver::probeChildren(StackFrame& frame)
+{
+	frame.childrenProbed = true;
+	const int count = frame.moves.size();
+	for (int i = 0; i < count; i++) {
+		const GameState::CompactMove move = frame.moves[i];
+		GameState::UndoInfo undo = searchState.makeMove(move);
+		bool childTransposed;
+		frame.childKeys[i] = canonicalKey(searchState, childTransposed);
+		// Dynamic win condition check: the opponent has already won there
+		frame.childData[i] = 0;
+		if (searchState.isWinningForPlayer(searchState.getCurrentPlayer())) {
+			frame.childData[i] = TranspositionTable::makeData(TranspositionTable::Result::WIN, GameState::CompactMove::NONE, 0, 0);
 		}
-		else {
-			// Handle unexplored states
-			StackFrame newFrame(nextState, nextState.generateAllPossibleMoves());
-			stateStack.push(newFrame);
-			return true;
+		// A pure race is decided without search
+		else if (searchState.isDisengaged()) {
+			int distance;
+			const bool isGood = raceResult(searchState, distance);
+			frame.childData[i] = TranspositionTable::makeData(isGood ? TranspositionTable::Result::WIN : TranspositionTable::Result::LOSS,
+				GameState::CompactMove::NONE, distance, 0);
 		}
+		searchState.unmakeMove(move, undo);
+		transpositionTable.prefetch(frame.childKeys[i]);
 	}
 
-	// Store results for current state
-	memoizationCache[frame.state] = { isGood, bestMove };
-	if (isGood) {
-		currentBestMove = { frame.state, bestMove };
+	for (int i = 0; i < count; i++) {
+		uint64_t data;
+		if (frame.childData[i] != 0) continue;
+		const bool hit = transpositionTable.probe(frame.childKeys[i], data) &&
+			TranspositionTable::resultOf(data) != TranspositionTable::Result::UNKNOWN;
+		stats.countProbe(hit);
+		if (hit) frame.childData[i] = data;
 	}
 
+	// Children lost for the opponent are recorded here, and marked so that processNextFrame skips them;
+	// the other known children are recorded in move order by processNextFrame
+	for (int i = 0; i < count; i++) {
+		if (frame.childData[i] != 0 && TranspositionTable::resultOf(frame.childData[i]) == TranspositionTable::Result::LOSS) {
+			recordChild(frame, frame.moves[i], false, TranspositionTable::distanceOf(frame.childData[i]));
+			frame.childData[i] = RECORDED_CHILD;
+			if (frame.evaluated) {
+				stats.countEtcCutoff();
+				return;
+			}
+		}
+	}
+}
+
+// Open a frame for the position reached by move (already applied to searchState)
+void GameSolver::pushFrame(const GameState::CompactMove& move, GameState::UndoInfo undo)
+{
+	nodesExpanded++;
+	StackFrame& frame = stateStack.emplace(searchState, nodesExpanded, move, undo);
+	const int depth = static_cast<int>(stateStack.size()) - 1;
+	stats.countNode(depth);
+	orderMoves(frame, depth);
+}
+
+// Close the top frame and take back the move that entered it
+void GameSolver::popFrame()
+{
+	const StackFrame& frame = stateStack.top();
+	if (!frame.isRoot()) {
+		searchState.unmakeMove(frame.move, frame.undo);
+	}
+	stateStack.pop();
+}
+
+// Record the result of the top frame (searchState is its position) in the frame and in the table
+void GameSolver::resolveFrame(StackFrame& frame, bool isGood, GameState::CompactMove bestMove, int distance)
+{
 	frame.evaluated = true;
-	return true;
+	frame.isGood = isGood;
+	frame.bestMove = bestMove;
+	frame.distance = distance;
+
+	const TranspositionTable::Result result = isGood ? TranspositionTable::Result::WIN : TranspositionTable::Result::LOSS;
+	const GameState::CompactMove stored = toStoredMove(searchState, bestMove, frame.transposed);
+	transpositionTable.store(frame.key, TranspositionTable::makeData(result, stored.bits, distance, nodesExpanded - frame.nodesAtEntry));
+	stats.countStore();
+}
+
+// Fold the result of a child (reached by move) into frame, resolving it once the answer is known
+void GameSolver::recordChild(StackFrame& frame, GameState::CompactMove move, bool childIsGood, int childDistance)
+{
+	const int distance = childDistance + 1;
+	if (!childIsGood) {
+		// The opponent is in a bad state, we have a winning move
+		recordCutoff(move, static_cast<int>(stateStack.size()) - 1, distance);
+		if (frame.winDistance < 0 || distance < frame.winDistance) {
+			frame.winMove = move;
+			frame.winDistance = distance;
+		}
+		// A win in one move cannot be beaten, otherwise only exact mode looks further
+		if (!exactDistance || distance == 1) {
+			resolveFrame(frame, true, frame.winMove, frame.winDistance);
+		}
+	}
+	else if (distance > frame.longestDistance) {
+		frame.longestMove = move;
+		frame.longestDistance = distance;
+	}
+}
+
+GameSolver::GameSolver(const GameState& initialState, size_t ttMegabytes) : ownedTable(new TranspositionTable(ttMegabytes)),
+	transpositionTable(*ownedTable), currentBestMove{ initialState, GameState::Move(-1, -1, -1, -1) }, rootSolved(false),
+	rootIsGood(false), rootDistance(0), exactDistance(false), searchState(initialState), nodesExpanded(0)
+{
+	pushRoot(initialState);
+}
+
+GameSolver::GameSolver(const GameState& initialState, TranspositionTable& sharedTable) : transpositionTable(sharedTable),
+	currentBestMove{ initialState, GameState::Move(-1, -1, -1, -1) }, rootSolved(false), rootIsGood(false),
+	rootDistance(0), exactDistance(false), searchState(initialState), nodesExpanded(0)
+{
+	pushRoot(initialState);
 }
 
-GameSolver::GameSolver(const GameState& initialState) :currentBestMove{ initialState, GameState::Move(-1, -1, -1, -1) }
+void GameSolver::pushRoot(const GameState& initialState)
 {
-	stateStack.push(StackFrame(initialState, initialState.generateAllPossibleMoves()));
+	// Every move advances a token by at least one cell, so no game is longer than the
+	// total distance all tokens can travel: the stack is sized once for the whole solve
+	const int size = initialState.getSize();
+	const int longestGame = 2 * (size - 2) * (size - 1) + 1;
+	stateStack.reserve(longestGame);
+	killers.assign(longestGame + 1, {});
+	history.fill(0);
+	StackFrame& root = stateStack.emplace(initialState, nodesExpanded);
+	stats.countNode(0);
+	orderMoves(root, 0);
+
+	// Base case: current Player has already won
+	if (initialState.isWinningForPlayer(initialState.getCurrentPlayer())) {
+		resolveFrame(root, true, GameState::CompactMove(), 0);
+	}
+	else if (initialState.isDisengaged()) {
+		int distance;
+		const bool isGood = raceResult(initialState, distance);
+		resolveFrame(root, isGood, initialState.firstRetiredStep(), distance);
+	}
+}
+
+// Winning moves are tried first, so the search is only as fast as its ordering: killer moves of
+// this depth, then steps that stop an opponent token, then jumps (two cells at once), then the
+// history score. Ties keep the generation order, so the search is reproducible.
+void GameSolver::orderMoves(StackFrame& frame, int ply)
+{
+	const int size = searchState.getSize();
+	uint64_t scores[GameState::MAX_MOVES];
+	for (int i = 0; i < frame.moves.size(); i++) {
+		const GameState::CompactMove move = frame.moves[i];
+		const int to = move.toCell(size);
+		const int row = to / size;
+		const int col = to % size;
+		// Player 1 lands in front of a Player 2 token coming from the left, Player 2 in front of one coming from above
+		const bool blocks = move.isPlayer2()
+			? row > 0 && searchState.getCellStatus(row - 1, col) == GameState::CellStatus::PLAYER_1
+			: col > 0 && searchState.getCellStatus(row, col - 1) == GameState::CellStatus::PLAYER_2;
+
+		uint64_t score = history[move.bits];
+		if (move.isJump()) score |= 1ull << 32;
+		if (blocks) score |= 1ull << 33;
+		if (move == killers[ply][1]) score |= 1ull << 34;
+		if (move == killers[ply][0]) score |= 1ull << 35;
+		scores[i] = score;
+	}
+
+	// Insertion sort, at most 2 * (size - 2) moves
+	for (int i = 1; i < frame.moves.size(); i++) {
+		const GameState::CompactMove move = frame.moves.moves[i];
+		const uint64_t score = scores[i];
+		int j = i;
+		for (; j > 0 && scores[j - 1] < score; j--) {
+			frame.moves.moves[j] = frame.moves.moves[j - 1];
+			scores[j] = scores[j - 1];
+		}
+		frame.moves.moves[j] = move;
+		scores[j] = score;
+	}
+}
+
+// A winning move is remembered as a killer of its depth and scores history by the square of
+// the distance it wins in, so refutations of large subtrees outweigh those near the end
+void GameSolver::recordCutoff(GameState::CompactMove move, int ply, int distance)
+{
+	std::array<GameState::CompactMove, KILLER_SLOTS>& slots = killers[ply];
+	if (!(slots[0] == move)) {
+		slots[1] = slots[0];
+		slots[0] = move;
+	}
+	const uint32_t bonus = static_cast<uint32_t>(distance * distance);
+	history[move.bits] = history[move.bits] > UINT32_MAX - bonus ? UINT32_MAX : history[move.bits] + bonus;
+}
+
+void GameSolver::setExactDistance(bool exact)
+{
+	exactDistance = exact;
+}
+
+void GameSolver::setCancelCheck(std::function<bool()> check)
+{
+	cancelCheck = std::move(check);
 }
 
 bool GameSolver::solve()
 {
 	/*return isGoodState(currentBestMove.first);*/
+	stats.start();
+	// Table and stack are allocated up front, so their size is the peak for the whole solve
+	const int size = currentBestMove.first.getSize();
+	stats.notePeakMemory(transpositionTable.getMemoryBytes() + (2 * (size - 2) * (size - 1) + 1) * sizeof(StackFrame));
+
+	uint64_t frames = 0;
 	while (!stateStack.isEmpty()) {
+		// Abandon the search when the caller no longer needs the result, rootSolved stays false
+		if (cancelCheck && ++frames % CANCEL_POLL_INTERVAL == 0 && cancelCheck()) {
+			stats.stop();
+			return false;
+		}
 		if (!processNextFrame()) {
 			break; // No more frames to process
 		}
 	}
 
-	// return the result of the last processed frame
-	return memoizationCache[currentBestMove.first].isGood;
+	stats.stop();
+	TRACE(Info, "Solve finished: root {} in {} plies, {} nodes", rootIsGood ? 1 : 0, rootDistance, stats.snapshot().nodesExpanded);
+	// return the result of the root state
+	return rootIsGood;
 }
 
 std::pair<GameState, GameState::Move> GameSolver::getBestMove() const
@@ -152,14 +380,68 @@ std::pair<GameState, GameState::Move> GameSolver::getBestMove() const
 
 bool GameSolver::hasWinningStrategy() const
 {
-	// Check if memoization cache is empty
-	if (memoizationCache.empty())
+	// Nothing is known before the root is solved
+	if (!rootSolved)
 	{
 		return false; // No winning strategy found
 	}
-	return memoizationCache.at(currentBestMove.first).isGood;
+	return rootIsGood;
+}
+
+TranspositionTable::Counters GameSolver::getTableCounters() const
+{
+	return transpositionTable.getCounters();
+}
+
+uint64_t GameSolver::canonicalKey(const GameState& state, bool& transposed)
+{
+	const PackedState packed = state.toCollapsedPackedState();
+	const PackedState mirror = packed.transposed(state.getSize() - 2);
+	transposed = mirror < packed;
+	return hashPackedState(transposed ? mirror : packed);
+}
+
+bool GameSolver::raceResult(const GameState& state, int& distance)
+{
+	// With a cells left for the side to move and b for the opponent, the side to move finishes
+	// after 2a plies when a <= b, otherwise the opponent finishes first after 2b + 1
+	const GameState::Player current = state.getCurrentPlayer();
+	const int own = state.remainingDistance(current);
+	const int opponent = state.remainingDistance(current == GameState::Player::PLAYER1 ? GameState::Player::PLAYER2 : GameState::Player::PLAYER1);
+	if (own <= opponent) {
+		distance = 2 * own;
+		return true;
+	}
+	distance = 2 * opponent + 1;
+	return false;
+}
+
+GameState::CompactMove GameSolver::toStoredMove(const GameState& state, GameState::CompactMove move, bool transposed)
+{
+	if (move.isValid() && state.isRetiredMove(move)) {
+		move = GameState::CompactMove::spareStep(move.isPlayer2());
+	}
+	return transposed ? move.transposed(state.getSize()) : move;
+}
+
+GameState::CompactMove GameSolver::fromStoredMove(const GameState& state, GameState::CompactMove stored, bool transposed)
+{
+	GameState::CompactMove move = transposed ? stored.transposed(state.getSize()) : stored;
+	return move.isSpareStep() ? state.firstRetiredStep() : move;
+}
+
+GameSolver::StackFrame::StackFrame(const GameState& state, uint64_t nodes) : move(), undo{}, moveIndex(0),
+	evaluated(false), isGood(false), bestMove(), distance(0), winMove(), winDistance(-1), longestMove(), longestDistance(-1),
+	nodesAtEntry(nodes), childrenProbed(false)
+{
+	state.generateAllPossibleMoves(moves);
+	key = canonicalKey(state, transposed);
 }
 
-GameSolver::StackFrame::StackFrame(GameState s, vector<GameState::Move> m) : state(s), moveIndex(0), moves(m), evaluated(false)
+GameSolver::StackFrame::StackFrame(const GameState& state, uint64_t nodes, GameState::CompactMove entered, GameState::UndoInfo u) : move(entered), undo(u), moveIndex(0),
+	evaluated(false), isGood(false), bestMove(), distance(0), winMove(), winDistance(-1), longestMove(), longestDistance(-1),
+	nodesAtEntry(nodes), childrenProbed(false)
 {
+	state.generateAllPossibleMoves(moves);
+	key = canonicalKey(state, transposed);
 }
@@ -1,59 +1,154 @@
 #pragma once
-#include <unordered_map>
 #include "Stack.cpp"
 #include <vector>
+#include <array>
 #include <utility>
+#include <memory>
+#include <functional>
 // #include <stdexcept> // Uncomment if you need to throw exceptions
 #include "GameState.h"
+#include "TranspositionTable.h"
+#include "SolverStats.h"
 
 class GameSolver
 {
-private:
-	// Memoization structure
-	struct StateResult
-	{
-		bool isGood;
-		GameState::Move bestMove;
-	};
+public:
+	// Memory budget of the transposition table when none is given
+	static const size_t DEFAULT_TT_MEGABYTES = 64;
+	// Number of frames processed between two polls of the cancel check
+	static const uint64_t CANCEL_POLL_INTERVAL = 1024;
+
+	// Canonical table key, transposed tells whether stored moves must be mapped back
+	static uint64_t canonicalKey(const GameState& state, bool& transposed);
+
+	// Conversions between a move in state and the form stored in the table for its canonical key
+	// (moves of retired tokens are stored as CompactMove::spareStep)
+	static GameState::CompactMove toStoredMove(const GameState& state, GameState::CompactMove move, bool transposed);
+	static GameState::CompactMove fromStoredMove(const GameState& state, GameState::CompactMove stored, bool transposed);
+
+	// Closed-form result of a disengaged position (GameState::isDisengaged): both sides only step,
+	// so the side to move wins exactly when it has no more cells left to travel than the opponent.
+	// Returns whether the side to move wins, distance is the exact number of plies to the end
+	static bool raceResult(const GameState& state, int& distance);
 
+private:
 	// Stack-based backtracking state
+	// frames no longer hold a GameState: the solver walks the tree on searchState and
+	// every frame remembers the move that entered it so popping can take it back
 	struct StackFrame {
-		GameState state;
-		size_t moveIndex; // Current move being processed
-		vector<GameState::Move> moves;
-		bool evaluated;
+		GameState::CompactMove move; // Move that led to this frame (invalid for the root)
+		GameState::UndoInfo undo;
+		int moveIndex; // Next move to try
+		GameState::MoveList moves; // fixed-capacity buffer, no heap allocation per frame
+		bool evaluated; // result known, waiting to be handed to the parent
+		bool isGood;
+		GameState::CompactMove bestMove;
+		int distance; // plies to the end of the game with best play
+		GameState::CompactMove winMove; // shortest win found so far (winDistance -1 when none)
+		int winDistance;
+		GameState::CompactMove longestMove; // child that keeps the game going longest
+		int longestDistance;
+		uint64_t key; // transposition table key of the canonical state
+		bool transposed;
+		uint64_t nodesAtEntry; // nodes expanded before this frame, gives the solved subtree size
+		bool childrenProbed; // every child looked up once (see probeChildren)
+		uint64_t childKeys[GameState::MAX_MOVES]; // table key of each child
+		uint64_t childData[GameState::MAX_MOVES]; // its table entry at that time, 0 when unknown, RECORDED_CHILD once folded in
 
 		// Constructor
 		StackFrame() = default;
-		explicit StackFrame(GameState s, vector<GameState::Move> m);
+		StackFrame(const GameState& state, uint64_t nodes);
+		StackFrame(const GameState& state, uint64_t nodes, GameState::CompactMove entered, GameState::UndoInfo u);
+
+		bool isRoot() const { return !move.isValid(); }
 	};
 
 	// Core recursive solving function using backtracking with memoization and minimax decision making
-	bool isGoodState(const GameState& state);
+	bool isGoodState(const GameState& state, int& distance);
 
-	// Memoization Cache were we store the results of previously computed states
-	std::unordered_map<GameState, StateResult, GameState::GameStateHash> memoizationCache;
+	// Transposition table were we store the results of previously computed states.
+	// Keys are canonical: retired tokens collapsed into spare step counts, then the smaller encoding
+	// under the transpose-and-swap symmetry, with bestMove expressed on that canonical board.
+	// Either owned by the solver or shared with other solvers (see ParallelSolver)
+	std::unique_ptr<TranspositionTable> ownedTable;
+	TranspositionTable& transpositionTable;
 
-	// Current best moves found
+	// Root state and the best move found for it
 	std::pair<GameState, GameState::Move> currentBestMove;
+	bool rootSolved;
+	bool rootIsGood;
+	int rootDistance;
+
+	// Evaluate every child to find the shortest win instead of stopping at the first one
+	bool exactDistance;
+
+	// The single state mutated in place with makeMove/unmakeMove during the search
+	GameState searchState;
+
+	// childData marker of a child already folded into its frame by probeChildren (no table entry has result bits 3)
+	static const uint64_t RECORDED_CHILD = ~uint64_t(0);
 
 	// State stack for backtracking
 	Stack<StackFrame> stateStack;
+	uint64_t nodesExpanded;
 
+	// Move ordering (see orderMoves): the last two winning moves found at each stack depth and
+	// a history score per move (indexed by CompactMove bits) raised every time the move wins
+	static const int KILLER_SLOTS = 2;
+	std::vector<std::array<GameState::CompactMove, KILLER_SLOTS>> killers;
+	std::array<uint32_t, 1 << 9> history;
+
+	// Polled during solve, returning true abandons the search
+	std::function<bool()> cancelCheck;
+
+	SolverStats stats;
+
+	void pushRoot(const GameState& initialState);
 	bool processNextFrame();
+	void pushFrame(const GameState::CompactMove& move, GameState::UndoInfo undo);
+	void probeChildren(StackFrame& frame);
+	void popFrame();
+	void resolveFrame(StackFrame& frame, bool isGood, GameState::CompactMove bestMove, int distance);
+	void recordChild(StackFrame& frame, GameState::CompactMove move, bool childIsGood, int childDistance);
+	void orderMoves(StackFrame& frame, int ply);
+	void recordCutoff(GameState::CompactMove move, int ply, int distance);
 
 public:
-	// Constructor
-	explicit GameSolver(const GameState& initialState);
+	// Constructor, ttMegabytes is the memory budget of the transposition table
+	explicit GameSolver(const GameState& initialState, size_t ttMegabytes = DEFAULT_TT_MEGABYTES);
+
+	// Constructor for a solver that reads and fills a table owned by the caller
+	GameSolver(const GameState& initialState, TranspositionTable& sharedTable);
+
+	// Off by default: solve stops at the first winning move, so the distance of a win is that of the
+	// line found. On, every child is searched and a win takes the shortest route (slower)
+	void setExactDistance(bool exact);
+
+	// Install a check polled every CANCEL_POLL_INTERVAL frames, solve stops when it returns true
+	void setCancelCheck(std::function<bool()> check);
 
 	// Main solving function
 	bool solve();
 
-	// Get the best move found
+	// Get the best move found: the shortest win when winning, the longest resistance when losing
 	std::pair<GameState, GameState::Move> getBestMove() const;
 
+	// Plies until the game ends when both sides follow the best moves (0 when the root is already decided)
+	int getDistance() const { return rootDistance; }
+
 	// Check if a winning startegy exists
 	bool hasWinningStrategy() const;
 
-};
+	// False until solve finished without being cancelled
+	bool isSolved() const { return rootSolved; }
+
+	// Positions expanded (frames pushed) by solve
+	uint64_t getNodesExpanded() const { return nodesExpanded; }
 
+	// Counters of the solve so far, safe to call from another thread while solve runs
+	SolverStats::Snapshot getStats() const { return stats.snapshot(); }
+
+	// Transposition table hit/miss/store/overwrite counters
+	TranspositionTable::Counters getTableCounters() const;
+
+};
@@ -1,41 +1,336 @@
 #include "GameState.h"
 #include <stdexcept>
-#include <iostream>
+#include "Trace.h"
+
+namespace {
+	// Random keys for every (player, cell) pair and for the side to move, generated once from a fixed seed
+	struct ZobristKeys
+	{
+		uint64_t cells[2][MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+		uint64_t player2ToMove;
+
+		ZobristKeys()
+		{
+			uint64_t seed = 0x2545F4914F6CDD1DULL;
+			auto next = [&seed]() { seed += 0x9e3779b97f4a7c15ULL; return mixBits(seed); };
+			for (auto& player : cells) {
+				for (auto& key : player) key = next();
+			}
+			player2ToMove = next();
+		}
+	};
+
+	const ZobristKeys zobrist;
+
+	enum class MaskKind { BOARD, NOT_FIRST_COLUMN, LAST_ROW, LAST_COLUMN };
+
+	// Rectangular regions used by the retired token test
+	template<int N>
+	struct RegionMasks
+	{
+		Bitboard rowsFrom[N]; // rows >= index
+		Bitboard rowsUpTo[N]; // rows <= index
+		Bitboard colsFrom[N]; // columns >= index
+		Bitboard colsUpTo[N]; // columns <= index
+	};
+
+	template<int N>
+	constexpr RegionMasks<N> buildRegions()
+	{
+		RegionMasks<N> regions{};
+		for (int row = 0; row < N; row++) {
+			for (int col = 0; col < N; col++) {
+				const Bitboard cell = Bitboard::cell(row * N + col);
+				for (int line = 0; line < N; line++) {
+					if (row >= line) regions.rowsFrom[line] = regions.rowsFrom[line] | cell;
+					if (row <= line) regions.rowsUpTo[line] = regions.rowsUpTo[line] | cell;
+					if (col >= line) regions.colsFrom[line] = regions.colsFrom[line] | cell;
+					if (col <= line) regions.colsUpTo[line] = regions.colsUpTo[line] | cell;
+				}
+			}
+		}
+		return regions;
+	}
+
+	template<int N>
+	constexpr Bitboard buildMask(MaskKind kind)
+	{
+		Bitboard mask;
+		for (int row = 0; row < N; row++) {
+			for (int col = 0; col < N; col++) {
+				const bool included = kind == MaskKind::BOARD ||
+					(kind == MaskKind::NOT_FIRST_COLUMN && col != 0) ||
+					(kind == MaskKind::LAST_ROW && row == N - 1) ||
+					(kind == MaskKind::LAST_COLUMN && col == N - 1);
+				if (included) mask = mask | Bitboard::cell(row * N + col);
+			}
+		}
+		return mask;
+	}
+
+	// Board routines for a size known at compile time, the compiler folds every shift,
+	// mask and division by N into constants
+	template<int N>
+	struct SizedBoard
+	{
+		static constexpr int LANES = N - 2;
+		static constexpr Bitboard board = buildMask<N>(MaskKind::BOARD);
+		static constexpr Bitboard notFirstColumn = buildMask<N>(MaskKind::NOT_FIRST_COLUMN); // drops Player 2 shifts that wrap into the next row
+		static constexpr Bitboard lastRow = buildMask<N>(MaskKind::LAST_ROW);                // Player 1 goal
+		static constexpr Bitboard lastColumn = buildMask<N>(MaskKind::LAST_COLUMN);          // Player 2 goal
+		static constexpr RegionMasks<N> regions = buildRegions<N>();
+
+		// Moves are found with shift-and-mask operations on the occupancy bitboards:
+		// shifting by N moves every Player 1 token one row down, shifting by 1 moves
+		// every Player 2 token one column right
+		static int generateMoves(Bitboard player1, Bitboard player2, bool player2ToMove, GameState::MoveList& moves)
+		{
+			moves.count = 0;
+			const Bitboard empty = board & ~(player1 | player2);
+
+			if (!player2ToMove) {
+				// Regular move down (1 step) and jump move down (2 steps over opponent)
+				Bitboard steps = (player1 << N) & empty;
+				Bitboard jumps = (((player1 << N) & player2) << N) & empty;
+
+				while (!steps.isEmpty()) {
+					moves.add(GameState::CompactMove(steps.popLowest() - N, false, false));
+				}
+				while (!jumps.isEmpty()) {
+					moves.add(GameState::CompactMove(jumps.popLowest() - 2 * N, true, false));
+				}
+			}
+			else {
+				// Regular move right (1 step) and jump move right (2 steps over opponent)
+				// tokens shifted out of the last column land on column 0 of the next row and are masked out
+				Bitboard steps = (player2 << 1) & notFirstColumn & empty;
+				Bitboard jumps = (((player2 << 1) & notFirstColumn & player1) << 1) & notFirstColumn & empty;
+
+				while (!steps.isEmpty()) {
+					moves.add(GameState::CompactMove(steps.popLowest() - 1, false, true));
+				}
+				while (!jumps.isEmpty()) {
+					moves.add(GameState::CompactMove(jumps.popLowest() - 2, true, true));
+				}
+			}
+
+			return moves.count;
+		}
+
+		static int countHome(Bitboard tokens, bool player2)
+		{
+			return (tokens & (player2 ? lastColumn : lastRow)).popCount();
+		}
+
+		// A Player 1 token at (row, col) can only meet Player 2 tokens at rows >= row that have not
+		// passed its column yet, and symmetrically for Player 2; without any, the token is retired
+		static Bitboard reachOf(int index, bool player2)
+		{
+			const int row = index / N;
+			const int col = index % N;
+			return player2 ? regions.rowsUpTo[row] & regions.colsFrom[col]
+				: regions.rowsFrom[row] & regions.colsUpTo[col];
+		}
+
+		static bool isRetired(Bitboard opponents, int index, bool player2)
+		{
+			return (opponents & reachOf(index, player2)).isEmpty();
+		}
+
+		static void retiredTokens(Bitboard player1, Bitboard player2, Bitboard& retired1, Bitboard& retired2)
+		{
+			retired1 = Bitboard();
+			retired2 = Bitboard();
+			Bitboard tokens = player1;
+			while (!tokens.isEmpty()) {
+				int index = tokens.popLowest();
+				if (isRetired(player2, index, false)) retired1.set(index);
+			}
+			tokens = player2;
+			while (!tokens.isEmpty()) {
+				int index = tokens.popLowest();
+				if (isRetired(player1, index, true)) retired2.set(index);
+			}
+		}
+
+		// A Player 1 token and a Player 2 token can meet exactly when each lies in the other's reach,
+		// so checking the Player 1 tokens alone decides whether any pair can still meet
+		static bool isDisengaged(Bitboard player1, Bitboard player2)
+		{
+			while (!player1.isEmpty()) {
+				if (!isRetired(player2, player1.popLowest(), false)) return false;
+			}
+			return true;
+		}
+
+		// Flood fill over the "can meet" relation, alternating between the two players' tokens
+		static int interactionComponents(Bitboard player1, Bitboard player2)
+		{
+			int components = 0;
+			Bitboard unvisited = player1;
+			while (!unvisited.isEmpty()) {
+				Bitboard group2 = reachOf(unvisited.popLowest(), false) & player2;
+				if (group2.isEmpty()) continue; // retired
+				components++;
+
+				Bitboard frontier = group2;
+				while (!frontier.isEmpty()) {
+					Bitboard linked1 = reachOf(frontier.popLowest(), true) & unvisited;
+					unvisited = unvisited & ~linked1;
+					while (!linked1.isEmpty()) {
+						const Bitboard added = reachOf(linked1.popLowest(), false) & player2 & ~group2;
+						group2 = group2 | added;
+						frontier = frontier | added;
+					}
+				}
+			}
+			return components;
+		}
+
+		static int remainingDistance(Bitboard tokens, bool player2)
+		{
+			int total = 0;
+			while (!tokens.isEmpty()) {
+				const int index = tokens.popLowest();
+				total += N - 1 - (player2 ? index % N : index / N);
+			}
+			return total;
+		}
+
+		static PackedState pack(Bitboard player1, Bitboard player2, bool player2ToMove)
+		{
+			PackedState packed;
+
+			// Player 1 lane = column - 1, the stored value is the token row
+			while (!player1.isEmpty()) {
+				int index = player1.popLowest();
+				packed.setPlayer1Lane(index % N - 1, index / N);
+			}
+
+			// Player 2 lane = row - 1, the stored value is the token column
+			while (!player2.isEmpty()) {
+				int index = player2.popLowest();
+				packed.setPlayer2Lane(LANES, index / N - 1, index % N);
+			}
+
+			packed.setPlayer2ToMove(LANES, player2ToMove);
+			return packed;
+		}
+
+		static PackedState packCollapsed(Bitboard player1, Bitboard player2, bool player2ToMove)
+		{
+			PackedState packed;
+			int spare1 = 0;
+			int spare2 = 0;
+
+			Bitboard tokens = player1;
+			while (!tokens.isEmpty()) {
+				int index = tokens.popLowest();
+				if (isRetired(player2, index, false)) {
+					packed.setPlayer1Lane(index % N - 1, PackedState::RETIRED_LANE);
+					spare1 += N - 1 - index / N;
+				}
+				else {
+					packed.setPlayer1Lane(index % N - 1, index / N);
+				}
+			}
+
+			tokens = player2;
+			while (!tokens.isEmpty()) {
+				int index = tokens.popLowest();
+				if (isRetired(player1, index, true)) {
+					packed.setPlayer2Lane(LANES, index / N - 1, PackedState::RETIRED_LANE);
+					spare2 += N - 1 - index % N;
+				}
+				else {
+					packed.setPlayer2Lane(LANES, index / N - 1, index % N);
+				}
+			}
+
+			packed.setPlayer2ToMove(LANES, player2ToMove);
+			packed.setSpareSteps(LANES, false, spare1);
+			packed.setSpareSteps(LANES, true, spare2);
+			return packed;
+		}
+
+		static constexpr GameState::Kernel kernel()
+		{
+			return { &generateMoves, &countHome, &pack, &packCollapsed, &retiredTokens, &isDisengaged, &remainingDistance,
+				&interactionComponents };
+		}
+	};
+}
+
+const GameState::Kernel& GameState::kernelFor(int size)
+{
+	static const Kernel kernels[MAX_BOARD_SIZE + 1] = {
+		{}, {}, {},
+		SizedBoard<3>::kernel(), SizedBoard<4>::kernel(), SizedBoard<5>::kernel(), SizedBoard<6>::kernel(),
+		SizedBoard<7>::kernel(), SizedBoard<8>::kernel(), SizedBoard<9>::kernel(), SizedBoard<10>::kernel()
+	};
+	return kernels[size];
+}
 
 GameState::GameState(int size)
 {
 	if (size < 3)
 	{
-		// for debugging purposes ONLY comment on push
-		std::cerr << "Invalid size: " << size << std::endl;
+		TRACE(Error, "Invalid size: {}", size);
 		throw std::invalid_argument("Size must be at least 3.");
 	}
+	if (size > MAX_BOARD_SIZE)
+	{
+		TRACE(Error, "Invalid size: {}", size);
+		throw std::invalid_argument("Size must be at most 10.");
+	}
 	this->size = size;
-	boardGrid.resize(size, vector<CellStatus>(size, CellStatus::EMPTY));
+	kernel = &kernelFor(size);
 	currentPlayer = Player::PLAYER1;
 
 	// Initialize player1 tokens on top border
 	for (int col = 1; col < size-1; col++)
 	{
-		boardGrid[0][col] = CellStatus::PLAYER_1;
-		Player1Tokens.insert({ 0, col });
+		player1Bits.set(col);
 	}
 
 	// Initialize player2 tokens on left border
 	for (int row = 1; row < size-1; row++)
 	{
-		boardGrid[row][0] = CellStatus::PLAYER_2;
-		Player2Tokens.insert({ row, 0 });
+		player2Bits.set(row * size);
+	}
+
+	zobristKey = computeZobristKey();
+	tokensHome[0] = 0;
+	tokensHome[1] = 0;
+}
+
+// Rebuild a position from its packed lanes (plain encoding, not the collapsed solver key)
+GameState::GameState(const PackedState& packed, int size) : GameState(size)
+{
+	const int lanes = size - 2;
+	player1Bits = Bitboard();
+	player2Bits = Bitboard();
+	for (int lane = 0; lane < lanes; lane++)
+	{
+		player1Bits.set(packed.getPlayer1Lane(lane) * size + lane + 1);
+		player2Bits.set((lane + 1) * size + packed.getPlayer2Lane(lanes, lane));
 	}
+	currentPlayer = packed.isPlayer2ToMove(lanes) ? Player::PLAYER2 : Player::PLAYER1;
+	zobristKey = computeZobristKey();
+	tokensHome[0] = kernel->countHome(player1Bits, false);
+	tokensHome[1] = kernel->countHome(player2Bits, true);
 }
 
 GameState::GameState(const GameState& other)
 {
 	this->size = other.size;
-	this->boardGrid = other.boardGrid;
+	this->kernel = other.kernel;
+	this->player1Bits = other.player1Bits;
+	this->player2Bits = other.player2Bits;
 	this->currentPlayer = other.currentPlayer;
-	this->Player1Tokens = other.Player1Tokens;
-	this->Player2Tokens = other.Player2Tokens;
+	this->zobristKey = other.zobristKey;
+	this->tokensHome[0] = other.tokensHome[0];
+	this->tokensHome[1] = other.tokensHome[1];
 }
 
 GameState::~GameState()
@@ -49,111 +344,59 @@ GameState& GameState::operator=(const GameState& other)
 	// TODO: insert return statement here
 	if (this != &other) {
 		this->size = other.size;
-		this->boardGrid = other.boardGrid;
+		this->kernel = other.kernel;
+		this->player1Bits = other.player1Bits;
+		this->player2Bits = other.player2Bits;
 		this->currentPlayer = other.currentPlayer;
-		this->Player1Tokens = other.Player1Tokens;
-		this->Player2Tokens = other.Player2Tokens;
+		this->zobristKey = other.zobristKey;
+		this->tokensHome[0] = other.tokensHome[0];
+		this->tokensHome[1] = other.tokensHome[1];
 	}
 	return *this;
 }
 
 bool GameState::operator==(const GameState& other) const
 {
-	return boardGrid == other.boardGrid &&
+	return size == other.size &&
 			currentPlayer == other.currentPlayer &&
-			Player1Tokens == other.Player1Tokens &&
-			Player2Tokens == other.Player2Tokens;
+			player1Bits == other.player1Bits &&
+			player2Bits == other.player2Bits;
 }
 
 // Generate all possible moves for the current player
 vector<GameState::Move> GameState::generateAllPossibleMoves() const
 {
-	vector<Move> moves;
+	MoveList compactMoves;
+	generateAllPossibleMoves(compactMoves);
 
-	if (currentPlayer == Player::PLAYER1) {
-		for (const auto& token : Player1Tokens) {
-			int row = token.first;
-			int col = token.second;
-			// Check all possible moves for Player 1
-			
-			// Regualr move down (1 step)
-			if (row + 1 < size && boardGrid[row + 1][col] == CellStatus::EMPTY) {
-				moves.emplace_back(row, col, row + 1, col);
-			}
-
-			// Jump move down (2 steps over opponent)
-			if (row + 2 < size && boardGrid[row + 1][col] == CellStatus::PLAYER_2 && boardGrid[row + 2][col] == CellStatus::EMPTY) {
-				moves.emplace_back(row, col, row + 2, col);
-			}
-		}
-	}
-	else {
-		for (const auto& token : Player2Tokens) {
-			int row = token.first;
-			int col = token.second;
-			// Check all possible moves for Player 2
-			// Regular move right (1 step)
-			if (col + 1 < size && boardGrid[row][col + 1] == CellStatus::EMPTY) {
-				moves.emplace_back(row, col, row, col + 1);
-			}
-			// Jump move right (2 steps over opponent)
-			if (col + 2 < size && boardGrid[row][col + 1] == CellStatus::PLAYER_1 && boardGrid[row][col + 2] == CellStatus::EMPTY) {
-				moves.emplace_back(row, col, row, col + 2);
-			}
-		}
+	vector<Move> moves;
+	moves.reserve(compactMoves.size());
+	for (const CompactMove& move : compactMoves) {
+		moves.push_back(toMove(move));
 	}
-
 	return moves;
 }
 
+int GameState::generateAllPossibleMoves(MoveList& moves) const
+{
+	return kernel->generateMoves(player1Bits, player2Bits, currentPlayer == Player::PLAYER2, moves);
+}
+
 bool GameState::isWinning() const
 {
-	if (currentPlayer == Player::PLAYER1) {
-		// Check if Player 1 has reached the bottom row
-		for (const auto& token : Player1Tokens) {
-			if (token.first != size - 1) {
-				return false;
-			}
-		}
-		return true;
-	}
-	else {
-		// Check if Player 2 has reached the right column
-		for (const auto& token : Player2Tokens) {
-			if (token.second != size - 1) {
-				return false;
-			}
-		}
-		return true;
-		
-	}
+	return isWinningForPlayer(currentPlayer);
 }
 
 bool GameState::isWinningForPlayer(Player player) const
 {
-	if (player == Player::PLAYER1) {
-		// Player 1 wins if all tokens are at the bottom
-		for (const auto& token : Player1Tokens) {
-			if (token.first != size - 1) return false;
-		}
-		return true;
-	}
-	else {
-		// Player 2 wins if all tokens are at the right
-		for (const auto& token : Player2Tokens) {
-			if (token.second != size - 1) return false;
-		}
-		return true;
-	}
+	// Player 1 wins if all tokens are at the bottom, Player 2 if all tokens are at the right
+	return tokensHome[player == Player::PLAYER1 ? 0 : 1] == size - 2;
 }
 
 GameState GameState::applyMove(int fromRow, int fromCol, int toRow, int toCol) const
 {
 	if (!isValidMove(fromRow, fromCol, toRow, toCol)) {
-		// for debugging purposes ONLY comment on push
-		std::cerr << "Invalid move attempted: ("
-			<< fromRow << "," << fromCol << ") to ("
-			<< toRow << "," << toCol << ")\n";
+		TRACE(Error, "Invalid move attempted: ({},{}) to ({},{})", fromRow, fromCol, toRow, toCol);
 		throw std::invalid_argument("Invalid move");
 	}
 	GameState newState(*this); // Create a copy of the current state without referencing
@@ -165,10 +408,7 @@ GameState GameState::applyMove(int fromRow, int fromCol, int toRow, int toCol) c
 GameState GameState::applyMove(const Move& move) const
 {
 	if (!isValidMove(move.fromRow, move.fromCol, move.toRow, move.toCol)) {
-		// for debugging purposes ONLY comment on push
-		std::cerr << "Invalid move attempted: ("
-			<< move.fromRow << "," << move.fromCol << ") to ("
-			<< move.toRow << "," << move.toCol << ")\n";
+		TRACE(Error, "Invalid move attempted: ({},{}) to ({},{})", move.fromRow, move.fromCol, move.toRow, move.toCol);
 		throw std::invalid_argument("Invalid move");
 	}
 	GameState newState(*this); // Create a copy of the current state without referencing
@@ -177,6 +417,99 @@ GameState GameState::applyMove(const Move& move) const
 	return newState;
 }
 
+PackedState GameState::toPackedState() const
+{
+	return kernel->pack(player1Bits, player2Bits, currentPlayer == Player::PLAYER2);
+}
+
+PackedState GameState::toCollapsedPackedState() const
+{
+	return kernel->packCollapsed(player1Bits, player2Bits, currentPlayer == Player::PLAYER2);
+}
+
+bool GameState::isRetiredMove(const CompactMove& move) const
+{
+	Bitboard retired1, retired2;
+	kernel->retiredTokens(player1Bits, player2Bits, retired1, retired2);
+	return (move.isPlayer2() ? retired2 : retired1).test(move.fromCell());
+}
+
+GameState::CompactMove GameState::firstRetiredStep() const
+{
+	Bitboard retired1, retired2;
+	kernel->retiredTokens(player1Bits, player2Bits, retired1, retired2);
+	const bool player2 = currentPlayer == Player::PLAYER2;
+	Bitboard tokens = player2 ? retired2 : retired1;
+	while (!tokens.isEmpty()) {
+		int index = tokens.popLowest();
+		if (player2 ? index % size != size - 1 : index / size != size - 1) {
+			return CompactMove(index, false, player2);
+		}
+	}
+	return CompactMove();
+}
+
+bool GameState::isDisengaged() const
+{
+	return kernel->isDisengaged(player1Bits, player2Bits);
+}
+
+int GameState::countInteractionComponents() const
+{
+	return kernel->interactionComponents(player1Bits, player2Bits);
+}
+
+int GameState::remainingDistance(Player player) const
+{
+	return player == Player::PLAYER1 ? kernel->remainingDistance(player1Bits, false) : kernel->remainingDistance(player2Bits, true);
+}
+
+GameState::UndoInfo GameState::makeMove(const Move& move)
+{
+	UndoInfo undo{ zobristKey };
+	moveToken(move.fromRow, move.fromCol, move.toRow, move.toCol);
+	switchPlayer();
+	return undo;
+}
+
+void GameState::unmakeMove(const Move& move, UndoInfo undo)
+{
+	switchPlayer();
+	moveToken(move.toRow, move.toCol, move.fromRow, move.fromCol);
+	zobristKey = undo.zobristKey;
+}
+
+GameState::UndoInfo GameState::makeMove(const CompactMove& move)
+{
+	UndoInfo undo{ zobristKey };
+	moveToken(move.fromCell(), move.toCell(size));
+	switchPlayer();
+	return undo;
+}
+
+void GameState::unmakeMove(const CompactMove& move, UndoInfo undo)
+{
+	switchPlayer();
+	moveToken(move.toCell(size), move.fromCell());
+	zobristKey = undo.zobristKey;
+}
+
+GameState::Move GameState::toMove(const CompactMove& move) const
+{
+	if (!move.isValid()) return Move(-1, -1, -1, -1);
+	const int from = move.fromCell();
+	const int to = move.toCell(size);
+	return Move(from / size, from % size, to / size, to % size);
+}
+
+GameState::CompactMove GameState::toCompactMove(const Move& move) const
+{
+	if (move.fromRow == -1) return CompactMove();
+	const bool player2 = move.toRow == move.fromRow;
+	const int distance = player2 ? move.toCol - move.fromCol : move.toRow - move.fromRow;
+	return CompactMove(move.fromRow * size + move.fromCol, distance == 2, player2);
+}
+
 // GameState::Player because Player is a nested enum class inside GameState
 GameState::Player GameState::getCurrentPlayer() const
 {
@@ -187,10 +520,15 @@ int GameState::getSize() const
 {
 	return size;
 }
+
+uint64_t GameState::getZobristKey() const
+{
+	return zobristKey;
+}
 // GameState::CellStatus because CellStatus is a nested enum class inside GameState
 GameState::CellStatus GameState::getCellStatus(int row, int col) const
 {
-	return boardGrid[row][col];
+	return cellAt(row, col);
 }
 
 string GameState::toString() const
@@ -215,7 +553,7 @@ string GameState::toString() const
 			}*/
 
 			// after searching we found that switch-case is faster than if-else in this case
-			switch (boardGrid[row][col])
+			switch (cellAt(row, col))
 			{
 			case CellStatus::EMPTY:
 				boardAsString += ". ";
@@ -247,7 +585,7 @@ bool GameState::isValidMove(int fromRow, int fromCol, int toRow, int toCol) cons
 		return false;
 
 	const CellStatus playerCell = (currentPlayer == Player::PLAYER1) ? CellStatus::PLAYER_1 : CellStatus::PLAYER_2;
-	if (boardGrid[fromRow][fromCol] != playerCell)
+	if (cellAt(fromRow, fromCol) != playerCell)
 		return false;
 
 	if (currentPlayer == Player::PLAYER1) {
@@ -256,12 +594,12 @@ bool GameState::isValidMove(int fromRow, int fromCol, int toRow, int toCol) cons
 
 		if (toRow == fromRow + 1) {
 			// Regular move
-			return boardGrid[toRow][toCol] == CellStatus::EMPTY;
+			return cellAt(toRow, toCol) == CellStatus::EMPTY;
 		}
 		else if (toRow == fromRow + 2) {
 			// Jump move
-			return boardGrid[fromRow + 1][fromCol] == CellStatus::PLAYER_2 &&
-				boardGrid[toRow][toCol] == CellStatus::EMPTY;
+			return cellAt(fromRow + 1, fromCol) == CellStatus::PLAYER_2 &&
+				cellAt(toRow, toCol) == CellStatus::EMPTY;
 		}
 	}
 	else { // Player 2
@@ -270,12 +608,12 @@ bool GameState::isValidMove(int fromRow, int fromCol, int toRow, int toCol) cons
 
 		if (toCol == fromCol + 1) {
 			// Regular move
-			return boardGrid[toRow][toCol] == CellStatus::EMPTY;
+			return cellAt(toRow, toCol) == CellStatus::EMPTY;
 		}
 		else if (toCol == fromCol + 2) {
 			// Jump move
-			return boardGrid[fromRow][fromCol + 1] == CellStatus::PLAYER_1 &&
-				boardGrid[toRow][toCol] == CellStatus::EMPTY;
+			return cellAt(fromRow, fromCol + 1) == CellStatus::PLAYER_1 &&
+				cellAt(toRow, toCol) == CellStatus::EMPTY;
 		}
 	}
 	return false;
@@ -288,23 +626,47 @@ bool GameState::isValidMove(const Move& move) const
 
 void GameState::moveToken(int fromRow, int fromCol, int toRow, int toCol)
 {
-	if (boardGrid[fromRow][fromCol] == CellStatus::PLAYER_1)
-	{
-		Player1Tokens.erase({ fromRow, fromCol });
-		Player1Tokens.insert({ toRow, toCol });
-	}
-	else {
-		Player2Tokens.erase({ fromRow, fromCol });
-		Player2Tokens.insert({ toRow, toCol });
-	}
+	moveToken(fromRow * size + fromCol, toRow * size + toCol);
+}
 
-	boardGrid[toRow][toCol] = boardGrid[fromRow][fromCol];
-	boardGrid[fromRow][fromCol] = CellStatus::EMPTY;
+void GameState::moveToken(int from, int to)
+{
+	const int player = player1Bits.test(from) ? 0 : 1;
+	Bitboard& tokens = player == 0 ? player1Bits : player2Bits;
+	tokens.clear(from);
+	tokens.set(to);
+	zobristKey ^= zobrist.cells[player][from] ^ zobrist.cells[player][to];
+
+	// Goal counters: Player 1 goal is the last row, Player 2 goal is the last column
+	const int goalFrom = player == 0 ? from / size : from % size;
+	const int goalTo = player == 0 ? to / size : to % size;
+	tokensHome[player] += (goalTo == size - 1) - (goalFrom == size - 1);
 }
 
 void GameState::switchPlayer()
 {
 	currentPlayer = (currentPlayer == Player::PLAYER1) ? Player::PLAYER2 : Player::PLAYER1;
+	zobristKey ^= zobrist.player2ToMove;
+}
+
+// Full Zobrist recomputation, only used when a state is built from scratch
+uint64_t GameState::computeZobristKey() const
+{
+	uint64_t key = 0;
+	Bitboard tokens = player1Bits;
+	while (!tokens.isEmpty()) key ^= zobrist.cells[0][tokens.popLowest()];
+	tokens = player2Bits;
+	while (!tokens.isEmpty()) key ^= zobrist.cells[1][tokens.popLowest()];
+	if (currentPlayer == Player::PLAYER2) key ^= zobrist.player2ToMove;
+	return key;
+}
+
+GameState::CellStatus GameState::cellAt(int row, int col) const
+{
+	const int index = row * size + col;
+	if (player1Bits.test(index)) return CellStatus::PLAYER_1;
+	if (player2Bits.test(index)) return CellStatus::PLAYER_2;
+	return CellStatus::EMPTY;
 }
 
 bool GameState::isInBounds(int row, int col) const
@@ -326,20 +688,8 @@ bool GameState::Move::operator==(const Move& other) const
 }
 
 // Hash function for GameState
-// This function generates a hash value for the GameState object
-// because GameState is a complex object, we need to hash its attributes and to avoid collisions while making solve() function
+// The Zobrist key is maintained incrementally, so hashing costs O(1) whatever the board size
 size_t GameState::GameStateHash::operator()(const GameState& state) const
 {
-	size_t hashValue = 0;
-	// Hash the size of the board
-	for (const auto& row : state.boardGrid) {
-		for (const auto& cell : row) {
-			hashValue ^= static_cast<int>(cell) + 0x9e3779b9 + (hashValue << 6) + (hashValue >> 2);
-		}
-	}
-
-	// Hash the current player
-	hashValue ^= static_cast<int>(state.currentPlayer);
-
-	return hashValue;
+	return static_cast<size_t>(state.zobristKey);
 }
@@ -1,9 +1,9 @@
 #pragma once
 #include <vector>
-#include <unordered_set>
 #include <string>
 #include <utility>
-#include "pair_hash.cpp"
+#include "Bitboard.h"
+#include "PackedState.h"
 
 using namespace std;
 
@@ -34,7 +34,70 @@ public:
 		bool operator==(const Move& other) const;
 	};
 
+	// Compact 16-bit move used by the search: cell index of the moving token,
+	// a jump flag and the moving player (Player 2 moves right, Player 1 moves down)
+	struct CompactMove
+	{
+		static const uint16_t NONE = 0xFFFF;
+		static const uint16_t JUMP = 1 << 7;
+		static const uint16_t PLAYER2 = 1 << 8;
+		static const int SPARE_CELL = 0x7F; // "step any retired token", used by the solver cache
+
+		uint16_t bits;
+
+		CompactMove() : bits(NONE) {}
+		CompactMove(int fromCell, bool jump, bool player2)
+			: bits(static_cast<uint16_t>(fromCell | (jump ? JUMP : 0) | (player2 ? PLAYER2 : 0))) {
+		}
+
+		static CompactMove spareStep(bool player2) { return CompactMove(SPARE_CELL, false, player2); }
+		static CompactMove fromBits(uint16_t bits) { CompactMove move; move.bits = bits; return move; }
+
+		bool isValid() const { return bits != NONE; }
+		bool isSpareStep() const { return isValid() && fromCell() == SPARE_CELL; }
+		int fromCell() const { return bits & 0x7F; }
+		bool isJump() const { return (bits & JUMP) != 0; }
+		bool isPlayer2() const { return (bits & PLAYER2) != 0; }
+		// Destination cell on a board of the given size
+		int toCell(int size) const { return fromCell() + (isPlayer2() ? 1 : size) * (isJump() ? 2 : 1); }
+
+		// Same move on the transposed board with the players swapped
+		CompactMove transposed(int size) const
+		{
+			if (!isValid()) return *this;
+			if (isSpareStep()) return spareStep(!isPlayer2());
+			const int from = fromCell();
+			return CompactMove((from % size) * size + from / size, isJump(), !isPlayer2());
+		}
+
+		bool operator==(const CompactMove& other) const { return bits == other.bits; }
+	};
+
+	// Maximum number of moves for one side: a step and a jump for each of the size - 2 tokens
+	static const int MAX_MOVES = 2 * (MAX_BOARD_SIZE - 2);
+
+	// Fixed-capacity move buffer meant to live on the caller's stack
+	struct MoveList
+	{
+		CompactMove moves[MAX_MOVES];
+		int count = 0;
+
+		void add(const CompactMove& move) { moves[count++] = move; }
+		int size() const { return count; }
+		bool empty() const { return count == 0; }
+		const CompactMove& operator[](int index) const { return moves[index]; }
+		const CompactMove* begin() const { return moves; }
+		const CompactMove* end() const { return moves + count; }
+	};
+
+	// Information needed to take back a move made with makeMove
+	struct UndoInfo
+	{
+		uint64_t zobristKey; // key before the move
+	};
+
 	// Adding hash support for GameState class
+	// returns the Zobrist key kept up to date by moveToken and switchPlayer
 	struct GameStateHash {
 		size_t operator()(const GameState& state) const;
 	};
@@ -42,6 +105,7 @@ public:
 
 	// Constructor and Destructor
 	explicit GameState(int size);
+	GameState(const PackedState& packed, int size);
 	GameState(const GameState& other);
 	~GameState();
 
@@ -53,15 +117,46 @@ public:
 
 	// Game mechanics
 	vector<Move> generateAllPossibleMoves() const;
+	// Allocation-free overload writing into a caller-provided buffer, returns the number of moves
+	int generateAllPossibleMoves(MoveList& moves) const;
 	bool isWinning() const;
 	bool isWinningForPlayer(Player player) const;
 	GameState applyMove(int fromRow, int fromCol, int toRow, int toCol) const;
 	// overloading the applyMove function to take Move object
 	GameState applyMove(const Move& move) const;
 
+	// In-place move application for search, the move must come from generateAllPossibleMoves
+	// (no validation is done, unlike applyMove)
+	UndoInfo makeMove(const Move& move);
+	void unmakeMove(const Move& move, UndoInfo undo);
+	UndoInfo makeMove(const CompactMove& move);
+	void unmakeMove(const CompactMove& move, UndoInfo undo);
+
+	// Conversions between the two move forms for this board size
+	Move toMove(const CompactMove& move) const;
+	CompactMove toCompactMove(const Move& move) const;
+
+	// Lane-indexed compact encoding (see PackedState.h)
+	PackedState toPackedState() const;
+	// Same encoding with retired tokens collapsed into spare step counts, used as the solver key
+	PackedState toCollapsedPackedState() const;
+
+	// Retired tokens can never meet an opponent token again (finished tokens included)
+	bool isRetiredMove(const CompactMove& move) const;
+	// Step of the first retired token of the side to move that is not home yet (invalid if none)
+	CompactMove firstRetiredStep() const;
+	// Every token is retired: the armies have disengaged and the rest of the game is a pure race
+	bool isDisengaged() const;
+	// Cells the tokens of the player still have to travel
+	int remainingDistance(Player player) const;
+	// Groups of tokens that can still meet each other (linked through any chain of possible meetings),
+	// retired tokens belong to none: 0 for a pure race
+	int countInteractionComponents() const;
+
 	// Accessors
 	Player getCurrentPlayer() const;
 	int getSize() const;
+	uint64_t getZobristKey() const;
 	CellStatus getCellStatus(int row, int col) const;
 
 	// View functions (for debugging if GUI is still in development)
@@ -73,17 +168,39 @@ public:
 	// Overloading isValidMove function to take Move object
 	bool isValidMove(const Move& move) const;
 
+	// Size-specialised routines, instantiated at compile time for every size from 3 to MAX_BOARD_SIZE
+	// (masks and loop bounds are constexpr in each instantiation, see SizedBoard in GameState.cpp)
+	struct Kernel
+	{
+		int (*generateMoves)(Bitboard player1, Bitboard player2, bool player2ToMove, MoveList& moves);
+		int (*countHome)(Bitboard tokens, bool player2);
+		PackedState (*pack)(Bitboard player1, Bitboard player2, bool player2ToMove);
+		PackedState (*packCollapsed)(Bitboard player1, Bitboard player2, bool player2ToMove);
+		void (*retiredTokens)(Bitboard player1, Bitboard player2, Bitboard& retired1, Bitboard& retired2);
+		bool (*isDisengaged)(Bitboard player1, Bitboard player2);
+		int (*remainingDistance)(Bitboard tokens, bool player2);
+		int (*interactionComponents)(Bitboard player1, Bitboard player2);
+	};
+
+	// Dispatch table lookup, picks the instantiation matching a runtime board size
+	static const Kernel& kernelFor(int size);
+
 private:
 	// Core GameState attributes
 	int size; // Size of the game board
-	vector<vector<CellStatus>> boardGrid; // 2D vector representing the game board
-	unordered_set<pair<int, int>,pair_hash> Player1Tokens; // Set of Player 1 tokens
-	unordered_set<pair<int, int>,pair_hash> Player2Tokens; // Set of Player 2 tokens
+	const Kernel* kernel; // Routines specialised for this size
+	Bitboard player1Bits; // Occupancy mask of Player 1 tokens
+	Bitboard player2Bits; // Occupancy mask of Player 2 tokens
 	Player currentPlayer; // Current player
+	uint64_t zobristKey; // Incremental hash of the token placement and side to move
+	int tokensHome[2]; // Tokens on their goal line per player, kept up to date by moveToken
 
 	// Helper functions
 	void moveToken(int fromRow, int fromCol, int toRow, int toCol);
+	void moveToken(int from, int to);
 	void switchPlayer();
+	CellStatus cellAt(int row, int col) const;
+	uint64_t computeZobristKey() const;
 
 	// Boundary check
 	bool isInBounds(int row, int col) const;
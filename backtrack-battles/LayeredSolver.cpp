@@ -0,0 +1,225 @@
+#include "LayeredSolver.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "GameSolver.h"
+
+namespace {
+	void sortUnique(std::vector<PackedState>& positions)
+	{
+		std::sort(positions.begin(), positions.end());
+		positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+	}
+
+	// Layers being filled are compacted whenever they grow past twice their last compacted size
+	const size_t MIN_COMPACT_SIZE = 4096;
+}
+
+LayeredSolver::LayeredSolver(const GameState& initialState, const std::string& spillDirectory) : initialState(initialState),
+	spillDirectory(spillDirectory), size(initialState.getSize()), rootBestMove(-1, -1, -1, -1), rootSolved(false),
+	rootIsGood(false), rootDistance(0), positionCount(0), layerCount(0), widestLayer(0), peakResident(0)
+{
+}
+
+bool LayeredSolver::solve()
+{
+	positionCount = 0;
+	layerCount = 0;
+	widestLayer = 0;
+	peakResident = 0;
+
+	const int rootLayer = advancement(initialState.toPackedState(), size);
+	const int deepest = enumerateLayers(rootLayer);
+
+	// Deepest layer first: the children of a layer are solved before it is read back
+	SolvedLayer next;      // layer + 1
+	SolvedLayer afterNext; // layer + 2
+	for (int layer = deepest; layer >= rootLayer; layer--) {
+		std::vector<PackedState> positions = readLayer(layer);
+		std::remove(layerPath(layer).c_str());
+
+		// The layer moves into solved, only the three solved layers are resident
+		SolvedLayer solved;
+		solveLayer(std::move(positions), next, afterNext, solved, layer == rootLayer);
+		notePeak(solved.positions.size() + next.positions.size() + afterNext.positions.size());
+		afterNext = std::move(next);
+		next = std::move(solved);
+	}
+
+	// Nothing else has the root's advancement, every other position lies further on
+	rootSolved = true;
+	rootIsGood = next.results[0].isGood;
+	rootDistance = next.results[0].distance;
+	return rootIsGood;
+}
+
+std::pair<GameState, GameState::Move> LayeredSolver::getBestMove() const
+{
+	return { initialState, rootBestMove };
+}
+
+int LayeredSolver::advancement(const PackedState& state, int size)
+{
+	// Tokens start on lane cell 0, so the lane values are the distances travelled
+	const int lanes = size - 2;
+	int total = 0;
+	for (int lane = 0; lane < lanes; lane++) {
+		total += state.getPlayer1Lane(lane) + state.getPlayer2Lane(lanes, lane);
+	}
+	return total;
+}
+
+int LayeredSolver::enumerateLayers(int rootLayer)
+{
+	// pending[A % 3] is layer A while it is expanded, layers A + 1 and A + 2 are still being filled
+	std::vector<PackedState> pending[3];
+	size_t compactedSize[3] = {};
+	pending[rootLayer % 3].push_back(initialState.toPackedState());
+
+	int deepest = rootLayer;
+	for (int layer = rootLayer; ; layer++) {
+		std::vector<PackedState>& current = pending[layer % 3];
+		sortUnique(current);
+		// A layer only receives from the two below it: two empty layers in a row end the game tree
+		if (current.empty() && pending[(layer + 1) % 3].empty()) {
+			break;
+		}
+		if (!current.empty()) {
+			deepest = layer;
+			layerCount++;
+			positionCount += current.size();
+			widestLayer = std::max<uint64_t>(widestLayer, current.size());
+		}
+		writeLayer(layer, current);
+
+		for (const PackedState& packed : current) {
+			GameState state(packed, size);
+			// Same terminal rule as GameSolver: the side to move has already won,
+			// and pure races are decided in closed form (GameSolver::raceResult) instead of enumerated
+			if (state.isWinningForPlayer(state.getCurrentPlayer()) || state.isDisengaged()) {
+				continue;
+			}
+
+			GameState::MoveList moves;
+			state.generateAllPossibleMoves(moves);
+			for (const GameState::CompactMove& move : moves) {
+				GameState::UndoInfo undo = state.makeMove(move);
+				pending[(layer + (move.isJump() ? 2 : 1)) % 3].push_back(state.toPackedState());
+				state.unmakeMove(move, undo);
+			}
+
+			// Transpositions are merged as the layers grow, keeping them near their real size
+			for (int ahead = 1; ahead <= 2; ahead++) {
+				const int index = (layer + ahead) % 3;
+				if (pending[index].size() > std::max(2 * compactedSize[index], MIN_COMPACT_SIZE)) {
+					sortUnique(pending[index]);
+					compactedSize[index] = pending[index].size();
+				}
+			}
+		}
+
+		notePeak(current.size() + pending[(layer + 1) % 3].size() + pending[(layer + 2) % 3].size());
+		std::vector<PackedState>().swap(current); // spilled, release the memory
+		compactedSize[layer % 3] = 0;
+	}
+	return deepest;
+}
+
+void LayeredSolver::solveLayer(std::vector<PackedState>&& positions, const SolvedLayer& next,
+	const SolvedLayer& afterNext, SolvedLayer& solved, bool isRootLayer)
+{
+	solved.positions = std::move(positions);
+	solved.results.resize(solved.positions.size());
+
+	for (size_t i = 0; i < solved.positions.size(); i++) {
+		GameState state(solved.positions[i], size);
+		if (state.isWinningForPlayer(state.getCurrentPlayer())) {
+			solved.results[i] = { true, 0 };
+			continue;
+		}
+		if (state.isDisengaged()) {
+			int distance;
+			const bool isGood = GameSolver::raceResult(state, distance);
+			solved.results[i] = { isGood, static_cast<uint8_t>(distance) };
+			if (isRootLayer) {
+				rootBestMove = state.toMove(state.firstRetiredStep());
+			}
+			continue;
+		}
+
+		GameState::MoveList moves;
+		state.generateAllPossibleMoves(moves);
+		GameState::CompactMove winMove;
+		int winDistance = -1;
+		GameState::CompactMove longestMove;
+		int longestDistance = 0; // no move left loses at once
+		for (const GameState::CompactMove& move : moves) {
+			GameState::UndoInfo undo = state.makeMove(move);
+			const PackedState child = state.toPackedState();
+			state.unmakeMove(move, undo);
+
+			// Steps land in the next layer, jumps in the one after
+			const SolvedLayer& childLayer = move.isJump() ? afterNext : next;
+			const auto found = std::lower_bound(childLayer.positions.begin(), childLayer.positions.end(), child);
+			const Result& childResult = childLayer.results[found - childLayer.positions.begin()];
+			const int distance = childResult.distance + 1;
+			if (!childResult.isGood) {
+				if (winDistance < 0 || distance < winDistance) {
+					winMove = move;
+					winDistance = distance;
+				}
+			}
+			else if (distance > longestDistance) {
+				longestMove = move;
+				longestDistance = distance;
+			}
+		}
+
+		const bool isGood = winDistance >= 0;
+		solved.results[i] = { isGood, static_cast<uint8_t>(isGood ? winDistance : longestDistance) };
+		if (isRootLayer) {
+			const GameState::CompactMove best = isGood ? winMove : longestMove;
+			if (best.isValid()) {
+				rootBestMove = state.toMove(best);
+			}
+		}
+	}
+}
+
+std::string LayeredSolver::layerPath(int layer) const
+{
+	return spillDirectory + "/layer-" + std::to_string(layer) + ".bin";
+}
+
+// Spill file: position count (8 bytes) followed by the sorted positions
+void LayeredSolver::writeLayer(int layer, const std::vector<PackedState>& positions) const
+{
+	const std::string path = layerPath(layer);
+	std::ofstream file(path, std::ios::binary);
+	const uint64_t count = positions.size();
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	file.write(reinterpret_cast<const char*>(positions.data()), static_cast<std::streamsize>(count * sizeof(PackedState)));
+	if (!file) {
+		throw std::runtime_error("Cannot write layer file " + path);
+	}
+}
+
+std::vector<PackedState> LayeredSolver::readLayer(int layer) const
+{
+	const std::string path = layerPath(layer);
+	std::ifstream file(path, std::ios::binary);
+	uint64_t count = 0;
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+	std::vector<PackedState> positions(file ? count : 0);
+	file.read(reinterpret_cast<char*>(positions.data()), static_cast<std::streamsize>(positions.size() * sizeof(PackedState)));
+	if (!file) {
+		throw std::runtime_error("Cannot read layer file " + path);
+	}
+	return positions;
+}
+
+void LayeredSolver::notePeak(uint64_t resident)
+{
+	peakResident = std::max(peakResident, resident);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "GameState.h"
+#include "PackedState.h"
+
+// Solver that never holds the whole reachable set: every move advances one token by one cell
+// (step) or two (jump), so the total advancement of all tokens splits the positions into layers,
+// and the children of layer A all lie in layers A + 1 and A + 2.
+//   1. Forward pass: breadth-first enumeration of the reachable positions, one layer at a time.
+//      A layer is complete once the two below it are expanded; it is then written to a spill file
+//      and dropped, so only the layer being expanded and the two being filled are in memory.
+//   2. Backward pass: from the deepest layer up to the root, each layer is read back and solved
+//      against the results of the two layers above it, which are then dropped.
+// Peak memory is about three times the widest layer (see getPeakResidentPositions).
+// Results follow GameSolver::solve and distances are exact (shortest win, longest resistance).
+class LayeredSolver
+{
+public:
+	// Spill files (layer-<advancement>.bin) are written to spillDirectory and removed once read back
+	explicit LayeredSolver(const GameState& initialState, const std::string& spillDirectory = ".");
+
+	// Main solving function, throws std::runtime_error when a spill file cannot be written or read
+	bool solve();
+
+	// Shortest win, or the move holding out longest when the root is lost
+	std::pair<GameState, GameState::Move> getBestMove() const;
+
+	// Plies to the end of the game with best play from both sides
+	int getDistance() const { return rootDistance; }
+
+	bool hasWinningStrategy() const { return rootSolved && rootIsGood; }
+	bool isSolved() const { return rootSolved; }
+
+	// Reachable positions, number of non-empty layers and size of the widest one
+	uint64_t getPositionCount() const { return positionCount; }
+	int getLayerCount() const { return layerCount; }
+	uint64_t getWidestLayer() const { return widestLayer; }
+
+	// Largest number of positions held in memory at the same time during solve
+	uint64_t getPeakResidentPositions() const { return peakResident; }
+
+private:
+	// Result of the side to move, with the plies to the end of the game
+	struct Result
+	{
+		bool isGood;
+		uint8_t distance;
+	};
+
+	// Sorted positions of one layer and their results (same order)
+	struct SolvedLayer
+	{
+		std::vector<PackedState> positions;
+		std::vector<Result> results;
+	};
+
+	GameState initialState;
+	std::string spillDirectory;
+	int size;
+
+	GameState::Move rootBestMove;
+	bool rootSolved;
+	bool rootIsGood;
+	int rootDistance;
+
+	uint64_t positionCount;
+	int layerCount;
+	uint64_t widestLayer;
+	uint64_t peakResident;
+
+	static int advancement(const PackedState& state, int size);
+
+	// Enumerates and spills every layer, returns the deepest non-empty one
+	int enumerateLayers(int rootLayer);
+	// Takes the layer over: its positions become solved.positions
+	void solveLayer(std::vector<PackedState>&& positions, const SolvedLayer& next, const SolvedLayer& afterNext,
+		SolvedLayer& solved, bool isRootLayer);
+
+	std::string layerPath(int layer) const;
+	void writeLayer(int layer, const std::vector<PackedState>& positions) const;
+	std::vector<PackedState> readLayer(int layer) const;
+	void notePeak(uint64_t resident);
+};
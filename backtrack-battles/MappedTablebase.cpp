@@ -0,0 +1,96 @@
+#include "MappedTablebase.h"
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	uint64_t readLittleEndian(const uint8_t* bytes, int count)
+	{
+		uint64_t value = 0;
+		for (int i = count - 1; i >= 0; i--) {
+			value = (value << 8) | bytes[i];
+		}
+		return value;
+	}
+}
+
+std::unique_ptr<MappedTablebase> MappedTablebase::open(const std::string& path)
+{
+	std::unique_ptr<MappedTablebase> table(new MappedTablebase());
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return nullptr;
+	table->fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) return nullptr;
+	table->length = static_cast<size_t>(fileSize.QuadPart);
+	if (table->length < Tablebase::HEADER_BYTES) return nullptr;
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) return nullptr;
+	table->mappingHandle = mapping;
+
+	table->view = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (table->view == nullptr) return nullptr;
+#else
+	const int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0) return nullptr;
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < Tablebase::HEADER_BYTES) {
+		close(file);
+		return nullptr;
+	}
+	table->length = static_cast<size_t>(status.st_size);
+
+	// The mapping stays valid after the descriptor is closed
+	void* view = mmap(nullptr, table->length, PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	if (view == MAP_FAILED) return nullptr;
+	table->view = static_cast<const uint8_t*>(view);
+#endif
+
+	// Header: magic, version, board size, format, position count
+	const uint8_t* header = table->view;
+	if (readLittleEndian(header, 4) != Tablebase::FILE_MAGIC ||
+		readLittleEndian(header + 4, 4) != Tablebase::FILE_VERSION) {
+		return nullptr;
+	}
+	table->size = static_cast<int>(readLittleEndian(header + 8, 4));
+	if (table->size < 3 || table->size > Tablebase::MAX_TABLEBASE_SIZE) {
+		return nullptr;
+	}
+	const uint64_t format = readLittleEndian(header + 12, 4);
+	if (format != static_cast<uint64_t>(Tablebase::Format::WIN_LOSS) && format != static_cast<uint64_t>(Tablebase::Format::DISTANCE)) {
+		return nullptr;
+	}
+	table->format = static_cast<Tablebase::Format>(format);
+	table->positionCount = readLittleEndian(header + 16, 8);
+	const uint64_t resultBytes = table->hasDistance() ? table->positionCount : (table->positionCount + 7) / 8;
+	if (table->positionCount != Tablebase::positionCount(table->size) ||
+		table->length - Tablebase::HEADER_BYTES < resultBytes) {
+		return nullptr; // truncated or from another layout
+	}
+	table->results = table->view + Tablebase::HEADER_BYTES;
+	return table;
+}
+
+MappedTablebase::~MappedTablebase()
+{
+#if defined(_WIN32)
+	if (view != nullptr) UnmapViewOfFile(view);
+	if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+	if (fileHandle != nullptr) CloseHandle(fileHandle);
+#else
+	if (view != nullptr) munmap(const_cast<uint8_t*>(view), length);
+#endif
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "Tablebase.h"
+
+// Read-only view of a file written by Tablebase::writeFile.
+// The file is memory mapped (CreateFileMapping on Windows, mmap elsewhere), so opening costs
+// no reads and a probe only touches the page holding the requested bit.
+class MappedTablebase
+{
+public:
+	// Maps the file and checks its header, returns nullptr when it is missing or not a valid tablebase
+	static std::unique_ptr<MappedTablebase> open(const std::string& path);
+
+	~MappedTablebase();
+	MappedTablebase(const MappedTablebase&) = delete;
+	MappedTablebase& operator=(const MappedTablebase&) = delete;
+
+	int getSize() const { return size; }
+	uint64_t getPositionCount() const { return positionCount; }
+
+	// Files of the DISTANCE format also know how long every position lasts
+	bool hasDistance() const { return format == Tablebase::Format::DISTANCE; }
+
+	// Result for the position of Tablebase::rank index, true when the side to move wins
+	bool isWin(uint64_t index) const
+	{
+		if (hasDistance()) return Tablebase::isWinEntry(results[index]);
+		return (results[index >> 3] >> (index & 7)) & 1;
+	}
+
+	// Plies to the end of the game with best play, only for files with distances
+	int distance(uint64_t index) const { return Tablebase::distanceOf(results[index]); }
+
+private:
+	MappedTablebase() = default;
+
+	const uint8_t* view = nullptr; // whole file
+	const uint8_t* results = nullptr; // first byte after the header
+	size_t length = 0;
+	int size = 0;
+	Tablebase::Format format = Tablebase::Format::WIN_LOSS;
+	uint64_t positionCount = 0;
+#if defined(_WIN32)
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
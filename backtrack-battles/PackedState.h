@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// Compact encoding of a position that relies on the fixed token lanes:
+// a Player 1 token never leaves its starting column and a Player 2 token never leaves its starting row,
+// so a position is one row index per Player 1 column, one column index per Player 2 row and the side to move.
+//
+// Layout for a board of size N with L = N - 2 lanes per player (4 bits per lane):
+//   bits [0, 4L)      row of the Player 1 token in column lane + 1
+//   bits [4L, 8L)     column of the Player 2 token in row lane + 1
+//   bit  8L           side to move (set when Player 2 is to move)
+//   bits [8L+1, 8L+15) spare steps of retired tokens, 7 bits per player (collapsed encoding only)
+// Every board up to 8x8 fits in the low word, larger boards spill into the high word.
+//
+// The collapsed encoding used by the solver replaces retired tokens (tokens that can never meet an
+// opponent token again, finished tokens included) with RETIRED_LANE and adds their remaining
+// distance to a per-player spare step count: such tokens only provide free single-step moves,
+// so positions that differ only in where those tokens stand share one encoding.
+struct PackedState
+{
+	static const int LANE_BITS = 4;
+	static const int RETIRED_LANE = 0xF;
+	static const int SPARE_BITS = 7;
+
+	uint64_t low;
+	uint64_t high;
+
+	PackedState() : low(0), high(0) {}
+
+	// Generic bit field access spanning both words
+	uint64_t getField(int offset, int width) const
+	{
+		uint64_t value;
+		if (offset >= 64) {
+			value = high >> (offset - 64);
+		}
+		else {
+			value = low >> offset;
+			if (offset + width > 64) value |= high << (64 - offset);
+		}
+		return value & ((uint64_t(1) << width) - 1);
+	}
+
+	void setField(int offset, int width, uint64_t value)
+	{
+		const uint64_t mask = (uint64_t(1) << width) - 1;
+		value &= mask;
+		if (offset >= 64) {
+			high = (high & ~(mask << (offset - 64))) | (value << (offset - 64));
+			return;
+		}
+		low = (low & ~(mask << offset)) | (value << offset);
+		if (offset + width > 64) {
+			const int spill = 64 - offset;
+			high = (high & ~(mask >> spill)) | (value >> spill);
+		}
+	}
+
+	// Lane accessors, lanes is the number of tokens per player (size - 2)
+	int getPlayer1Lane(int lane) const { return static_cast<int>(getField(lane * LANE_BITS, LANE_BITS)); }
+	int getPlayer2Lane(int lanes, int lane) const { return static_cast<int>(getField((lanes + lane) * LANE_BITS, LANE_BITS)); }
+	void setPlayer1Lane(int lane, int row) { setField(lane * LANE_BITS, LANE_BITS, row); }
+	void setPlayer2Lane(int lanes, int lane, int col) { setField((lanes + lane) * LANE_BITS, LANE_BITS, col); }
+
+	bool isPlayer2ToMove(int lanes) const { return getField(2 * lanes * LANE_BITS, 1) != 0; }
+	void setPlayer2ToMove(int lanes, bool player2) { setField(2 * lanes * LANE_BITS, 1, player2 ? 1 : 0); }
+
+	int getSpareSteps(int lanes, bool player2) const { return static_cast<int>(getField(spareOffset(lanes, player2), SPARE_BITS)); }
+	void setSpareSteps(int lanes, bool player2, int steps) { setField(spareOffset(lanes, player2), SPARE_BITS, steps); }
+	static int spareOffset(int lanes, bool player2) { return 2 * lanes * LANE_BITS + 1 + (player2 ? SPARE_BITS : 0); }
+
+	// Transposing the board and swapping the players maps Player 1 lanes onto Player 2 lanes
+	// (moving down becomes moving right) and hands the move to the other side,
+	// the resulting position has the same value for the side to move
+	PackedState transposed(int lanes) const
+	{
+		const int laneBits = lanes * LANE_BITS;
+		PackedState result;
+		result.setField(0, laneBits, getField(laneBits, laneBits));
+		result.setField(laneBits, laneBits, getField(0, laneBits));
+		result.setPlayer2ToMove(lanes, !isPlayer2ToMove(lanes));
+		result.setSpareSteps(lanes, false, getSpareSteps(lanes, true));
+		result.setSpareSteps(lanes, true, getSpareSteps(lanes, false));
+		return result;
+	}
+
+	bool operator==(const PackedState& other) const { return low == other.low && high == other.high; }
+	bool operator!=(const PackedState& other) const { return !(*this == other); }
+	bool operator<(const PackedState& other) const { return high != other.high ? high < other.high : low < other.low; }
+};
+
+// 64-bit mixer (splitmix64 finalizer) used to spread packed states over hash buckets
+inline uint64_t mixBits(uint64_t value)
+{
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ULL;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebULL;
+	value ^= value >> 31;
+	return value;
+}
+
+// 64-bit key of a packed state. mixBits is a bijection, so while the high word is zero
+// (boards up to 8x8) two different states never share a key
+inline uint64_t hashPackedState(const PackedState& state)
+{
+	return mixBits(state.low ^ mixBits(state.high));
+}
+
+struct PackedStateHash {
+	size_t operator()(const PackedState& state) const
+	{
+		return static_cast<size_t>(hashPackedState(state));
+	}
+};
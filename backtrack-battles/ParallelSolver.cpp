@@ -0,0 +1,279 @@
+#include "ParallelSolver.h"
+#include <thread>
+
+ParallelSolver::ParallelSolver(const GameState& initialState, int threadCount, size_t ttMegabytes, int splitDepth)
+	: transpositionTable(ttMegabytes), threadCount(threadCount), splitDepth(splitDepth), steals(0)
+{
+	if (this->threadCount <= 0) {
+		this->threadCount = static_cast<int>(std::thread::hardware_concurrency());
+		if (this->threadCount <= 0) this->threadCount = 1;
+	}
+	root = std::make_shared<Task>(initialState, GameState::CompactMove(), nullptr, 0);
+}
+
+bool ParallelSolver::solve()
+{
+	if (root->resolved.load(std::memory_order_acquire)) {
+		return root->isGood;
+	}
+
+	queues.clear();
+	for (int i = 0; i < threadCount; i++) {
+		queues.emplace_back(new WorkQueue());
+	}
+	queues[0]->tasks.push_back(root);
+	steals.store(0);
+	stats.start();
+
+	// The calling thread is worker 0
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threadCount; i++) {
+		workers.emplace_back(&ParallelSolver::runWorker, this, i);
+	}
+	runWorker(0);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	stats.stop();
+	// Tasks cancelled below resolved nodes may still be queued
+	queues.clear();
+	return root->isGood;
+}
+
+std::pair<GameState, GameState::Move> ParallelSolver::getBestMove() const
+{
+	if (!root->resolved.load(std::memory_order_acquire) || !root->bestMove.isValid()) {
+		return { root->state, GameState::Move(-1, -1, -1, -1) };
+	}
+	return { root->state, root->state.toMove(root->bestMove) };
+}
+
+SolverStats::Snapshot ParallelSolver::getStats() const
+{
+	SolverStats::Snapshot result;
+	{
+		std::lock_guard<std::mutex> guard(statsLock);
+		result = finishedStats;
+	}
+	result.merge(stats.snapshot());
+	// The table is shared, each worker holds the stack of one subtree solve at a time
+	result.peakMemoryBytes = transpositionTable.getMemoryBytes() + threadCount * result.peakMemoryBytes;
+	return result;
+}
+
+bool ParallelSolver::hasWinningStrategy() const
+{
+	return root->resolved.load(std::memory_order_acquire) && root->isGood;
+}
+
+void ParallelSolver::runWorker(int index)
+{
+	while (!root->resolved.load(std::memory_order_acquire)) {
+		std::shared_ptr<Task> task = takeTask(index);
+		if (!task) {
+			// Nothing to run or steal: the remaining tasks are being solved by other workers
+			std::this_thread::yield();
+			continue;
+		}
+		runTask(task, index);
+	}
+}
+
+std::shared_ptr<ParallelSolver::Task> ParallelSolver::takeTask(int index)
+{
+	{
+		WorkQueue& own = *queues[index];
+		std::lock_guard<std::mutex> guard(own.lock);
+		if (!own.tasks.empty()) {
+			std::shared_ptr<Task> task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return task;
+		}
+	}
+
+	// Steal from the other workers, starting with the next one
+	for (int offset = 1; offset < threadCount; offset++) {
+		WorkQueue& victim = *queues[(index + offset) % threadCount];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (!victim.tasks.empty()) {
+			std::shared_ptr<Task> task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			steals.fetch_add(1, std::memory_order_relaxed);
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+void ParallelSolver::runTask(const std::shared_ptr<Task>& task, int index)
+{
+	if (task->isCancelled()) {
+		return;
+	}
+	if (task->depth < splitDepth) {
+		expandTask(task, index);
+	}
+	else {
+		solveTask(task);
+	}
+}
+
+// Split a node into one task per child that is not already decided
+void ParallelSolver::expandTask(const std::shared_ptr<Task>& task, int index)
+{
+	const GameState& state = task->state;
+	{
+		std::lock_guard<std::mutex> guard(statsLock);
+		SolverStats::Snapshot split;
+		split.nodesExpanded = 1;
+		split.peakStackDepth = task->depth;
+		split.nodesPerDepth.assign(task->depth + 1, 0);
+		split.nodesPerDepth[task->depth] = 1;
+		finishedStats.merge(split);
+	}
+
+	// Base case: current Player has already won (only possible for the root, such children are never queued)
+	if (state.isWinningForPlayer(state.getCurrentPlayer())) {
+		resolveTask(*task, true, GameState::CompactMove(), 0);
+		return;
+	}
+
+	GameState::MoveList moves;
+	state.generateAllPossibleMoves(moves);
+
+	std::vector<std::shared_ptr<Task>> children;
+	for (const GameState::CompactMove& move : moves) {
+		GameState child = state;
+		child.makeMove(move);
+
+		bool transposed;
+		uint64_t data;
+		if (transpositionTable.probe(GameSolver::canonicalKey(child, transposed), data) &&
+			TranspositionTable::resultOf(data) != TranspositionTable::Result::UNKNOWN) {
+			if (TranspositionTable::resultOf(data) == TranspositionTable::Result::LOSS) {
+				resolveTask(*task, true, move, TranspositionTable::distanceOf(data) + 1);
+				return;
+			}
+			task->recordWonChild(move, TranspositionTable::distanceOf(data));
+			continue;
+		}
+
+		// The opponent has already won there
+		if (child.isWinningForPlayer(child.getCurrentPlayer())) {
+			task->recordWonChild(move, 0);
+			continue;
+		}
+
+		children.push_back(std::make_shared<Task>(child, move, task, task->depth + 1));
+	}
+
+	// all moves lead to good states for the opponent, we are in a bad state
+	if (children.empty()) {
+		resolveLostTask(*task);
+		return;
+	}
+
+	// The count must be in place before any child can finish
+	task->pendingChildren.store(static_cast<int>(children.size()), std::memory_order_release);
+
+	// Pushed in reverse so the owner pops them in move order
+	WorkQueue& own = *queues[index];
+	std::lock_guard<std::mutex> guard(own.lock);
+	for (auto it = children.rbegin(); it != children.rend(); ++it) {
+		own.tasks.push_back(std::move(*it));
+	}
+}
+
+// Solve a subtree below the split depth with the sequential solver on the shared table
+void ParallelSolver::solveTask(const std::shared_ptr<Task>& task)
+{
+	GameSolver solver(task->state, transpositionTable);
+	const Task* node = task.get();
+	solver.setCancelCheck([node]() { return node->isCancelled(); });
+	solver.solve();
+	{
+		// Keep the stack part of the memory only, the table is counted once by getStats
+		SolverStats::Snapshot subtree = solver.getStats();
+		subtree.peakMemoryBytes -= transpositionTable.getMemoryBytes();
+		std::lock_guard<std::mutex> guard(statsLock);
+		finishedStats.merge(subtree, task->depth);
+	}
+
+	if (!solver.isSolved()) {
+		return; // cancelled, the result is no longer needed
+	}
+	const GameState::Move best = solver.getBestMove().second;
+	resolveTask(*task, solver.hasWinningStrategy(),
+		best.fromRow >= 0 ? task->state.toCompactMove(best) : GameState::CompactMove(), solver.getDistance());
+}
+
+// Record the result of a task and hand it to the parent:
+// a lost child makes the parent won, the last won child makes the parent lost
+void ParallelSolver::resolveTask(Task& task, bool isGood, GameState::CompactMove bestMove, int distance)
+{
+	bool expected = false;
+	if (!task.claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+		return; // another child already decided this node
+	}
+	task.isGood = isGood;
+	task.bestMove = bestMove;
+	task.distance = distance;
+	task.resolved.store(true, std::memory_order_release);
+
+	bool transposed;
+	const uint64_t key = GameSolver::canonicalKey(task.state, transposed);
+	const GameState::CompactMove stored = GameSolver::toStoredMove(task.state, bestMove, transposed);
+	const TranspositionTable::Result result = isGood ? TranspositionTable::Result::WIN : TranspositionTable::Result::LOSS;
+	// Split nodes root large subtrees, keep them over anything solved sequentially
+	transpositionTable.store(key, TranspositionTable::makeData(result, stored.bits, distance, 0xFFFF));
+
+	Task* parent = task.parent.get();
+	if (parent == nullptr) {
+		return;
+	}
+	if (!isGood) {
+		resolveTask(*parent, true, task.move, distance + 1);
+		return;
+	}
+	parent->recordWonChild(task.move, distance);
+	if (parent->pendingChildren.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		resolveLostTask(*parent);
+	}
+}
+
+// Every child is won for the opponent: hold out along the longest of them
+void ParallelSolver::resolveLostTask(Task& task)
+{
+	const uint32_t longest = task.longestChild.load(std::memory_order_acquire);
+	if (longest == 0) {
+		resolveTask(task, false, GameState::CompactMove(), 0); // no move at all
+		return;
+	}
+	resolveTask(task, false, GameState::CompactMove::fromBits(static_cast<uint16_t>(longest & 0xFFFF)),
+		static_cast<int>(longest >> 16));
+}
+
+ParallelSolver::Task::Task(const GameState& state, GameState::CompactMove move, std::shared_ptr<Task> parent, int depth)
+	: state(state), move(move), parent(std::move(parent)), depth(depth), pendingChildren(0), longestChild(0), claimed(false),
+	resolved(false), isGood(false), bestMove(), distance(0)
+{
+}
+
+void ParallelSolver::Task::recordWonChild(GameState::CompactMove childMove, int childDistance)
+{
+	const uint32_t candidate = (static_cast<uint32_t>(childDistance + 1) << 16) | childMove.bits;
+	uint32_t current = longestChild.load(std::memory_order_relaxed);
+	while (current < candidate && !longestChild.compare_exchange_weak(current, candidate, std::memory_order_acq_rel)) {
+	}
+}
+
+bool ParallelSolver::Task::isCancelled() const
+{
+	for (const Task* node = this; node != nullptr; node = node->parent.get()) {
+		if (node->resolved.load(std::memory_order_acquire)) {
+			return true;
+		}
+	}
+	return false;
+}
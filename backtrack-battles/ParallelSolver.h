@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "GameState.h"
+#include "GameSolver.h"
+#include "TranspositionTable.h"
+#include "SolverStats.h"
+
+// Multi-threaded solver: the top of the game tree is expanded into tasks that a pool of workers
+// runs with work stealing, subtrees below the split depth are solved by a GameSolver each.
+// All workers share one TranspositionTable. A node is resolved as soon as one child is lost for
+// the opponent (or every child is won for it), which cancels the remaining work below that node.
+class ParallelSolver
+{
+public:
+	// Tasks are split off down to this depth, deeper subtrees are solved sequentially
+	static const int DEFAULT_SPLIT_DEPTH = 4;
+
+	// threadCount 0 uses every hardware thread
+	explicit ParallelSolver(const GameState& initialState, int threadCount = 0,
+		size_t ttMegabytes = GameSolver::DEFAULT_TT_MEGABYTES, int splitDepth = DEFAULT_SPLIT_DEPTH);
+
+	// Main solving function, blocks until every worker has stopped
+	bool solve();
+
+	// Get the best move found (the longest resistance when losing)
+	std::pair<GameState, GameState::Move> getBestMove() const;
+
+	// Plies until the game ends along the lines found, see GameSolver::getDistance
+	int getDistance() const { return root->distance; }
+
+	// Check if a winning startegy exists
+	bool hasWinningStrategy() const;
+
+	int getThreadCount() const { return threadCount; }
+
+	// Tasks taken from another worker's queue during the last solve
+	uint64_t getStealCount() const { return steals.load(); }
+
+	TranspositionTable::Counters getTableCounters() const { return transpositionTable.getCounters(); }
+
+	// Split nodes plus the counters of every finished subtree solve (depths relative to the root),
+	// safe to call from another thread while solve runs
+	SolverStats::Snapshot getStats() const;
+
+private:
+	// Node of the split part of the tree
+	struct Task
+	{
+		GameState state;
+		GameState::CompactMove move; // Move of the parent that led here (invalid for the root)
+		std::shared_ptr<Task> parent;
+		int depth;
+
+		std::atomic<int> pendingChildren; // children not yet known to be won for their side to move
+		std::atomic<uint32_t> longestChild; // (distance << 16) | move of the child holding out longest, 0 when none
+		std::atomic<bool> claimed;  // set by the single thread that resolves the task
+		std::atomic<bool> resolved; // set once isGood and bestMove are written
+		bool isGood;
+		GameState::CompactMove bestMove;
+		int distance;
+
+		Task(const GameState& state, GameState::CompactMove move, std::shared_ptr<Task> parent, int depth);
+
+		// A task is no longer needed once it or any ancestor is resolved
+		bool isCancelled() const;
+
+		// Fold a child won for the opponent into longestChild
+		void recordWonChild(GameState::CompactMove move, int childDistance);
+	};
+
+	// Per-worker double ended queue: the owner works depth first from the back,
+	// thieves take the oldest (largest) subtrees from the front
+	struct WorkQueue
+	{
+		std::mutex lock;
+		std::deque<std::shared_ptr<Task>> tasks;
+	};
+
+	TranspositionTable transpositionTable;
+	int threadCount;
+	int splitDepth;
+	std::shared_ptr<Task> root;
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+	std::atomic<uint64_t> steals;
+
+	SolverStats stats; // elapsed time and memory, written by the thread calling solve
+	mutable std::mutex statsLock;
+	SolverStats::Snapshot finishedStats; // guarded by statsLock
+
+	void runWorker(int index);
+	std::shared_ptr<Task> takeTask(int index);
+	void runTask(const std::shared_ptr<Task>& task, int index);
+	void expandTask(const std::shared_ptr<Task>& task, int index);
+	void solveTask(const std::shared_ptr<Task>& task);
+	void resolveTask(Task& task, bool isGood, GameState::CompactMove bestMove, int distance);
+	void resolveLostTask(Task& task);
+};
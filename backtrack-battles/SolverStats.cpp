@@ -0,0 +1,100 @@
+#include "SolverStats.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace {
+	int64_t nowTicks()
+	{
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+	}
+
+	double ticksToSeconds(int64_t ticks)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::duration(ticks)).count();
+	}
+}
+
+SolverStats::SolverStats() : startTicks(0), stopTicks(0)
+{
+}
+
+void SolverStats::start()
+{
+	stopTicks.store(0, std::memory_order_relaxed);
+	startTicks.store(nowTicks(), std::memory_order_relaxed);
+}
+
+void SolverStats::stop()
+{
+	stopTicks.store(nowTicks(), std::memory_order_relaxed);
+}
+
+SolverStats::Snapshot SolverStats::snapshot() const
+{
+	Snapshot result;
+	result.nodesExpanded = nodesExpanded.get();
+	result.tableProbes = tableProbes.get();
+	result.tableHits = tableHits.get();
+	result.tableStores = tableStores.get();
+	result.etcCutoffs = etcCutoffs.get();
+	result.peakStackDepth = static_cast<int>(peakStackDepth.get());
+	result.peakMemoryBytes = peakMemoryBytes.get();
+
+	const int64_t started = startTicks.load(std::memory_order_relaxed);
+	const int64_t stopped = stopTicks.load(std::memory_order_relaxed);
+	result.running = started != 0 && stopped == 0;
+	if (started != 0) {
+		result.elapsedSeconds = ticksToSeconds((result.running ? nowTicks() : stopped) - started);
+	}
+
+	int depths = MAX_TRACKED_DEPTH;
+	while (depths > 0 && nodesPerDepth[depths - 1].get() == 0) depths--;
+	result.nodesPerDepth.resize(depths);
+	for (int depth = 0; depth < depths; depth++) {
+		result.nodesPerDepth[depth] = nodesPerDepth[depth].get();
+	}
+	return result;
+}
+
+void SolverStats::Snapshot::merge(const Snapshot& other, int depthOffset)
+{
+	nodesExpanded += other.nodesExpanded;
+	tableProbes += other.tableProbes;
+	tableHits += other.tableHits;
+	tableStores += other.tableStores;
+	etcCutoffs += other.etcCutoffs;
+	peakStackDepth = std::max(peakStackDepth, other.peakStackDepth + depthOffset);
+	peakMemoryBytes = std::max(peakMemoryBytes, other.peakMemoryBytes);
+	elapsedSeconds = std::max(elapsedSeconds, other.elapsedSeconds);
+	running = running || other.running;
+
+	if (nodesPerDepth.size() < other.nodesPerDepth.size() + depthOffset) {
+		nodesPerDepth.resize(other.nodesPerDepth.size() + depthOffset);
+	}
+	for (size_t depth = 0; depth < other.nodesPerDepth.size(); depth++) {
+		nodesPerDepth[depth + depthOffset] += other.nodesPerDepth[depth];
+	}
+}
+
+std::string SolverStats::Snapshot::toJson() const
+{
+	std::ostringstream json;
+	json << "{\"nodesExpanded\":" << nodesExpanded
+		<< ",\"tableProbes\":" << tableProbes
+		<< ",\"tableHits\":" << tableHits
+		<< ",\"hitRate\":" << hitRate()
+		<< ",\"tableStores\":" << tableStores
+		<< ",\"etcCutoffs\":" << etcCutoffs
+		<< ",\"peakStackDepth\":" << peakStackDepth
+		<< ",\"peakMemoryBytes\":" << peakMemoryBytes
+		<< ",\"elapsedSeconds\":" << elapsedSeconds
+		<< ",\"nodesPerSecond\":" << nodesPerSecond()
+		<< ",\"running\":" << (running ? "true" : "false")
+		<< ",\"nodesPerDepth\":[";
+	for (size_t depth = 0; depth < nodesPerDepth.size(); depth++) {
+		json << (depth == 0 ? "" : ",") << nodesPerDepth[depth];
+	}
+	json << "]}";
+	return json.str();
+}
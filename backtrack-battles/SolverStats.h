@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counters of a solve. They are written by the solving thread only and can be read at any time
+// from another thread through snapshot(): relaxed atomics, so the search path has no locked
+// instruction and a snapshot taken mid-solve may mix counters from slightly different moments.
+class SolverStats
+{
+public:
+	// Stack depths tracked by the histogram (longest 10x10 game is 145 plies), deeper frames
+	// are counted in the last slot
+	static const int MAX_TRACKED_DEPTH = 160;
+
+	// Plain copy of the counters
+	struct Snapshot
+	{
+		uint64_t nodesExpanded = 0;
+		uint64_t tableProbes = 0;
+		uint64_t tableHits = 0;
+		uint64_t tableStores = 0;
+		uint64_t etcCutoffs = 0; // frames resolved by probing their children, without expanding any
+		int peakStackDepth = 0;
+		uint64_t peakMemoryBytes = 0; // transposition table and search stack
+		double elapsedSeconds = 0;
+		bool running = false;
+		std::vector<uint64_t> nodesPerDepth; // index = stack depth, trailing zeros trimmed
+
+		double hitRate() const { return tableProbes == 0 ? 0.0 : static_cast<double>(tableHits) / tableProbes; }
+		double nodesPerSecond() const { return elapsedSeconds > 0 ? nodesExpanded / elapsedSeconds : 0.0; }
+
+		// Adds the counters of a solve started depthOffset plies below this one (peaks and times take the maximum)
+		void merge(const Snapshot& other, int depthOffset = 0);
+
+		// One JSON object, keys in camelCase like the fields
+		std::string toJson() const;
+	};
+
+	SolverStats();
+	SolverStats(const SolverStats&) = delete;
+	SolverStats& operator=(const SolverStats&) = delete;
+
+	void start();
+	void stop();
+
+	void countNode(int depth)
+	{
+		nodesExpanded.increment();
+		nodesPerDepth[depth < MAX_TRACKED_DEPTH ? depth : MAX_TRACKED_DEPTH - 1].increment();
+		if (static_cast<uint64_t>(depth) > peakStackDepth.get()) peakStackDepth.set(depth);
+	}
+	void countProbe(bool hit)
+	{
+		tableProbes.increment();
+		if (hit) tableHits.increment();
+	}
+	void countStore() { tableStores.increment(); }
+	void countEtcCutoff() { etcCutoffs.increment(); }
+	void notePeakMemory(uint64_t bytes)
+	{
+		if (bytes > peakMemoryBytes.get()) peakMemoryBytes.set(bytes);
+	}
+
+	Snapshot snapshot() const;
+
+private:
+	// Single writer: a relaxed load and store instead of an atomic add
+	struct Counter
+	{
+		std::atomic<uint64_t> value{ 0 };
+		void increment() { value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+		void set(uint64_t newValue) { value.store(newValue, std::memory_order_relaxed); }
+		uint64_t get() const { return value.load(std::memory_order_relaxed); }
+	};
+
+	Counter nodesExpanded;
+	Counter tableProbes;
+	Counter tableHits;
+	Counter tableStores;
+	Counter etcCutoffs;
+	Counter peakStackDepth;
+	Counter peakMemoryBytes;
+	Counter nodesPerDepth[MAX_TRACKED_DEPTH];
+
+	// steady_clock ticks, stopTicks is 0 while running
+	std::atomic<int64_t> startTicks;
+	std::atomic<int64_t> stopTicks;
+};
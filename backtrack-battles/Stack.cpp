@@ -1,76 +1,103 @@
 #include <stdexcept>
+#include <new>
+#include <utility>
+#include <cstddef>
 
 /**
 
     @class   Stack
 	@brief   Stack class for managing game states.
 	@details Stack class that provides methods to push, pop, and access the top game state
-	using linkedlist for dynamic memory management.
-	@member topNode - Pointer to the top node of the stack.
-	@methods push, pop, top, isEmpty - Methods to manipulate the stack except for isEmpty.
-	@destructor - Destructor to clean up the stack when it goes out of scope and to prevent memory leaks.
+	using one contiguous growable buffer: frames are constructed in place, growing moves them
+	to a buffer twice as large, and pop only destroys the top frame (no allocation).
+	Reserving the maximum depth once per solve keeps the search loop allocation-free.
+	@member items - Buffer holding the frames, the top of the stack is items[count - 1].
+	@methods push, emplace, pop, top, reserve, isEmpty, size - Methods to manipulate the stack.
+	@destructor - Destructor to destroy the remaining frames and free the buffer.
 	@tparam  GameStateType - The type of the game state stored in the stack.
 
 **/
-/**
-	@struct StackNode
-	@brief  structure representing a node in the stack.
-	@details This structure contains a game state and a pointer to the next node in the stack.
-	Generic programming GameStateType type is used to make it data type-independent.
-	@tparam GameStateType - The type of the game state stored in the stack node.
-**/
 template<typename GameStateType>
 class Stack
 {
 private:
 
-	struct StackNode{
-		GameStateType gameState;
-		StackNode* next;
-	};
-	StackNode* topNode;
+	GameStateType* items;
+	size_t count;
+	size_t capacity;
 
+	void grow(size_t newCapacity) {
+		GameStateType* newItems = static_cast<GameStateType*>(::operator new(newCapacity * sizeof(GameStateType)));
+		for (size_t i = 0; i < count; i++) {
+			new (&newItems[i]) GameStateType(std::move(items[i]));
+			items[i].~GameStateType();
+		}
+		::operator delete(items);
+		items = newItems;
+		capacity = newCapacity;
+	}
 
 public:
 	Stack() {
-		topNode = nullptr;
+		items = nullptr;
+		count = 0;
+		capacity = 0;
 	}
 
+	// Frames are owned by the stack, copying it is never needed
+	Stack(const Stack&) = delete;
+	Stack& operator=(const Stack&) = delete;
+
 	bool isEmpty() const{
-		return topNode == nullptr;
+		return count == 0;
+	}
+
+	size_t size() const {
+		return count;
 	}
 
 	~Stack() {
 		while (!isEmpty()) {
-			StackNode* temp = topNode;
-			topNode = topNode->next;
-			delete temp;
+			pop();
 		}
+		::operator delete(items);
 	}
 
-	void push(const GameStateType& gameState) {
-		StackNode* newNode = new StackNode{ gameState, topNode };
-		/*newNode->gameState = gameState;
-		newNode->next = topNode;*/
-		topNode = newNode;
+	// Make room for depth frames up front
+	void reserve(size_t depth) {
+		if (depth > capacity) {
+			grow(depth);
+		}
+	}
+
+	void push(GameStateType&& gameState) {
+		emplace(std::move(gameState));
+	}
+
+	// Construct the new top frame in place
+	template<typename... Args>
+	GameStateType& emplace(Args&&... args) {
+		if (count == capacity) {
+			grow(capacity == 0 ? 16 : capacity * 2);
+		}
+		GameStateType* frame = new (&items[count]) GameStateType(std::forward<Args>(args)...);
+		count++;
+		return *frame;
 	}
 
-	GameStateType& pop() {
+	void pop() {
 		if (isEmpty()) {
 			throw std::out_of_range("Stack is empty");
 		}
-		StackNode* temp = topNode;
-		GameStateType data = topNode->gameState;
-		topNode = topNode->next;
-		delete temp;
-		return data;
+		count--;
+		items[count].~GameStateType();
 	}
 
 	GameStateType& top() const {
 		if (isEmpty()) {
 			throw std::out_of_range("Stack is empty");
 		}
-		return topNode->gameState;
+		return items[count - 1];
 	}
 
-};
\ No newline at end of file
+};
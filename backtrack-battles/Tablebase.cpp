@@ -0,0 +1,262 @@
+#include "Tablebase.h"
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	const int MAX_DIGITS = 2 * (Tablebase::MAX_TABLEBASE_SIZE - 2);
+
+	// Lane values of one position and the rank weight of every lane
+	struct LaneDigits
+	{
+		int size;
+		int lanes;
+		int count;
+		int digits[MAX_DIGITS];
+		uint64_t weights[MAX_DIGITS];
+
+		explicit LaneDigits(int size) : size(size), lanes(size - 2), count(2 * (size - 2))
+		{
+			uint64_t weight = 1;
+			for (int i = 0; i < count; i++) {
+				digits[i] = 0;
+				weights[i] = weight;
+				weight *= size;
+			}
+		}
+
+		int player1Row(int lane) const { return digits[lane]; }
+		int player2Col(int lane) const { return digits[lanes + lane]; }
+
+		// Token of the other player on (row, col), lanes only cross inside the board rows/columns 1..N-2
+		bool player2At(int row, int col) const { return row >= 1 && row <= size - 2 && player2Col(row - 1) == col; }
+		bool player1At(int row, int col) const { return col >= 1 && col <= size - 2 && player1Row(col - 1) == row; }
+
+		// Two tokens claim one cell, no game reaches this position
+		bool isImpossible() const
+		{
+			for (int lane = 0; lane < lanes; lane++) {
+				if (player2At(player1Row(lane), lane + 1)) return true;
+			}
+			return false;
+		}
+
+		bool isHome(bool player2) const
+		{
+			for (int lane = 0; lane < lanes; lane++) {
+				if ((player2 ? player2Col(lane) : player1Row(lane)) != size - 1) return false;
+			}
+			return true;
+		}
+
+		// Next smaller lane combination, digit 0 changes fastest
+		void decrement()
+		{
+			for (int i = 0; i < count; i++) {
+				if (digits[i] > 0) {
+					digits[i]--;
+					return;
+				}
+				digits[i] = size - 1;
+			}
+		}
+	};
+
+	// Calls visit(child rank) for every legal move of the side to move until visit returns false
+	template<typename Visit>
+	void forEachChild(const LaneDigits& lanes, uint64_t base, bool player2ToMove, Visit visit)
+	{
+		const int last = lanes.size - 1;
+		const uint64_t childSide = player2ToMove ? 0 : 1;
+		for (int lane = 0; lane < lanes.lanes; lane++) {
+			// Player 1 moves down column lane + 1, Player 2 moves right along row lane + 1
+			const int from = player2ToMove ? lanes.player2Col(lane) : lanes.player1Row(lane);
+			if (from >= last) continue;
+
+			const int line = lane + 1;
+			auto blocked = [&](int cell) {
+				return player2ToMove ? lanes.player1At(line, cell) : lanes.player2At(cell, line);
+			};
+			const uint64_t weight = lanes.weights[player2ToMove ? lanes.lanes + lane : lane];
+
+			int steps;
+			if (!blocked(from + 1)) {
+				steps = 1; // regular move
+			}
+			else if (from + 2 <= last && !blocked(from + 2)) {
+				steps = 2; // jump over the opponent token
+			}
+			else {
+				continue;
+			}
+
+			if (!visit(2 * (base + steps * weight) + childSide)) {
+				return;
+			}
+		}
+	}
+
+	// Value of the position for the side to move, all children are already in results
+	bool solvePosition(const LaneDigits& lanes, uint64_t base, bool player2ToMove, const std::vector<uint8_t>& results)
+	{
+		if (lanes.isHome(player2ToMove)) {
+			return true; // current Player has already won
+		}
+
+		bool isGood = false;
+		forEachChild(lanes, base, player2ToMove, [&](uint64_t child) {
+			isGood = !Tablebase::isWin(results, child); // the opponent is in a bad state
+			return !isGood;
+		});
+		// no move or every move leaves the opponent winning
+		return isGood;
+	}
+
+	// DISTANCE entry of the position: shortest win over the lost children, otherwise the longest loss
+	uint8_t solvePositionDistance(const LaneDigits& lanes, uint64_t base, bool player2ToMove, const std::vector<uint8_t>& entries)
+	{
+		if (lanes.isHome(player2ToMove)) {
+			return Tablebase::WIN_FLAG; // current Player has already won
+		}
+
+		int shortestWin = -1;
+		int longestLoss = 0;
+		forEachChild(lanes, base, player2ToMove, [&](uint64_t child) {
+			const uint8_t entry = entries[child];
+			const int distance = Tablebase::distanceOf(entry) + 1;
+			if (!Tablebase::isWinEntry(entry)) {
+				if (shortestWin < 0 || distance < shortestWin) shortestWin = distance;
+			}
+			else if (distance > longestLoss) {
+				longestLoss = distance;
+			}
+			return true;
+		});
+		return shortestWin >= 0 ? static_cast<uint8_t>(Tablebase::WIN_FLAG | shortestWin) : static_cast<uint8_t>(longestLoss);
+	}
+
+	// Checked before the results are allocated
+	void requireTablebaseSize(int size)
+	{
+		if (size < 3 || size > Tablebase::MAX_TABLEBASE_SIZE) {
+			throw std::invalid_argument("Tablebase size must be between 3 and 7.");
+		}
+	}
+
+	// Walks every possible lane combination from the largest rank down, solveBase(lanes, base)
+	// fills in both sides of one combination
+	template<typename SolveBase>
+	void walkRanks(int size, const std::function<void(uint64_t done, uint64_t total)>& progress, SolveBase solveBase)
+	{
+		// Start from the largest lane combination (every token home) and walk down
+		const uint64_t total = Tablebase::positionCount(size);
+		LaneDigits lanes(size);
+		for (int i = 0; i < lanes.count; i++) {
+			lanes.digits[i] = size - 1;
+		}
+
+		const uint64_t PROGRESS_INTERVAL = uint64_t(1) << 22;
+		for (uint64_t base = total / 2; base-- > 0; lanes.decrement()) {
+			if (progress && base % PROGRESS_INTERVAL == 0) {
+				progress(total - 2 * base, total);
+			}
+			if (!lanes.isImpossible()) {
+				solveBase(lanes, base);
+			}
+		}
+	}
+}
+
+uint64_t Tablebase::positionCount(int size)
+{
+	uint64_t count = 2;
+	for (int i = 0; i < 2 * (size - 2); i++) {
+		count *= size;
+	}
+	return count;
+}
+
+uint64_t Tablebase::rank(const PackedState& state, int size)
+{
+	const int lanes = size - 2;
+	uint64_t base = 0;
+	for (int lane = lanes - 1; lane >= 0; lane--) {
+		base = base * size + state.getPlayer2Lane(lanes, lane);
+	}
+	for (int lane = lanes - 1; lane >= 0; lane--) {
+		base = base * size + state.getPlayer1Lane(lane);
+	}
+	return 2 * base + (state.isPlayer2ToMove(lanes) ? 1 : 0);
+}
+
+uint64_t Tablebase::rank(const GameState& state)
+{
+	return rank(state.toPackedState(), state.getSize());
+}
+
+PackedState Tablebase::unrank(uint64_t index, int size)
+{
+	const int lanes = size - 2;
+	PackedState state;
+	state.setPlayer2ToMove(lanes, (index & 1) != 0);
+	uint64_t base = index >> 1;
+	for (int lane = 0; lane < lanes; lane++) {
+		state.setPlayer1Lane(lane, static_cast<int>(base % size));
+		base /= size;
+	}
+	for (int lane = 0; lane < lanes; lane++) {
+		state.setPlayer2Lane(lanes, lane, static_cast<int>(base % size));
+		base /= size;
+	}
+	return state;
+}
+
+std::vector<uint8_t> Tablebase::generate(int size, const std::function<void(uint64_t done, uint64_t total)>& progress)
+{
+	requireTablebaseSize(size);
+	std::vector<uint8_t> results((positionCount(size) + 7) / 8, 0);
+	walkRanks(size, progress, [&results](const LaneDigits& lanes, uint64_t base) {
+		for (int side = 1; side >= 0; side--) {
+			if (solvePosition(lanes, base, side == 1, results)) {
+				const uint64_t index = 2 * base + side;
+				results[index >> 3] |= static_cast<uint8_t>(1 << (index & 7));
+			}
+		}
+	});
+	return results;
+}
+
+std::vector<uint8_t> Tablebase::generateDistances(int size, const std::function<void(uint64_t done, uint64_t total)>& progress)
+{
+	requireTablebaseSize(size);
+	std::vector<uint8_t> entries(positionCount(size), 0);
+	walkRanks(size, progress, [&entries](const LaneDigits& lanes, uint64_t base) {
+		for (int side = 1; side >= 0; side--) {
+			entries[2 * base + side] = solvePositionDistance(lanes, base, side == 1, entries);
+		}
+	});
+	return entries;
+}
+
+void Tablebase::writeFile(const std::string& path, int size, const std::vector<uint8_t>& results, Format format)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Cannot open " + path + " for writing.");
+	}
+
+	uint8_t header[HEADER_BYTES] = {};
+	auto put = [&header](int offset, uint64_t value, int bytes) {
+		for (int i = 0; i < bytes; i++) header[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+	};
+	put(0, FILE_MAGIC, 4);
+	put(4, FILE_VERSION, 4);
+	put(8, static_cast<uint64_t>(size), 4);
+	put(12, static_cast<uint64_t>(format), 4);
+	put(16, positionCount(size), 8);
+
+	file.write(reinterpret_cast<const char*>(header), HEADER_BYTES);
+	file.write(reinterpret_cast<const char*>(results.data()), static_cast<std::streamsize>(results.size()));
+	if (!file) {
+		throw std::runtime_error("Failed to write " + path + ".");
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "PackedState.h"
+#include "GameState.h"
+
+// Retrograde analysis of every position of a board size, without any search.
+//
+// A position is ranked as a mixed-radix number over its lane encoding (see PackedState):
+//   rank = side + 2 * (lane[0] + N * lane[1] + N^2 * lane[2] + ...)
+// with the Player 1 lanes first, then the Player 2 lanes, and side = 1 when Player 2 is to move.
+// Every move raises one lane by one or two cells and flips the side, so a child always has a larger
+// rank than its parent: walking the ranks downwards solves every child before its parents.
+//
+// Two result formats:
+//   WIN_LOSS  one bit per rank, set when the side to move wins (same meaning as GameSolver::solve)
+//   DISTANCE  one byte per rank, bit 7 set when the side to move wins, bits 0-6 the number of plies
+//             to the end of the game when the winner takes the shortest win and the loser holds out longest
+// Ranks of impossible positions (two tokens on one cell) are left at 0.
+//
+// File layout (little endian): magic "BBTB", version, board size, format (4 bytes each),
+// position count (8 bytes), then the results, WIN_LOSS bit (rank % 8) of byte (rank / 8).
+class Tablebase
+{
+public:
+	// 7x7 has 2 * 7^10 positions (70 MB of results, 565 MB with distances), 8x8 would need 17 GB
+	static const int MAX_TABLEBASE_SIZE = 7;
+	static const uint32_t FILE_MAGIC = 0x42544242; // "BBTB"
+	static const uint32_t FILE_VERSION = 2;
+	static const size_t HEADER_BYTES = 24;
+
+	enum class Format : uint32_t { WIN_LOSS = 0, DISTANCE = 1 };
+	static const uint8_t WIN_FLAG = 0x80;
+
+	static uint64_t positionCount(int size);
+	static uint64_t rank(const PackedState& state, int size);
+	static uint64_t rank(const GameState& state);
+	static PackedState unrank(uint64_t index, int size);
+
+	// Solves every position of the board size, progress (when given) is called now and then
+	// with the number of ranks done and the total
+	static std::vector<uint8_t> generate(int size,
+		const std::function<void(uint64_t done, uint64_t total)>& progress = nullptr);
+
+	// Same walk keeping the distance of every position (DISTANCE format, 8 times larger)
+	static std::vector<uint8_t> generateDistances(int size,
+		const std::function<void(uint64_t done, uint64_t total)>& progress = nullptr);
+
+	static bool isWin(const std::vector<uint8_t>& results, uint64_t index)
+	{
+		return (results[index >> 3] >> (index & 7)) & 1;
+	}
+
+	// DISTANCE format entries
+	static bool isWinEntry(uint8_t entry) { return (entry & WIN_FLAG) != 0; }
+	static int distanceOf(uint8_t entry) { return entry & ~WIN_FLAG; }
+
+	// Throws std::runtime_error when the file cannot be written
+	static void writeFile(const std::string& path, int size, const std::vector<uint8_t>& results,
+		Format format = Format::WIN_LOSS);
+};
@@ -0,0 +1,120 @@
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace {
+	// Sequence protocol per slot: a writer claims ticket t, sets sequence to 0 while it writes the
+	// fields and to t + 1 once done. A reader copies the fields and keeps them only when the sequence
+	// was t + 1 both before and after the copy. Fields are relaxed atomics so a torn read is
+	// detected instead of being undefined behaviour.
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence{ 0 };
+		std::atomic<int64_t> ticks{ 0 };
+		std::atomic<int> level{ 0 };
+		std::atomic<const char*> format{ nullptr };
+		std::atomic<int64_t> arguments[Trace::MAX_ARGUMENTS] = {};
+	};
+
+	int64_t nowTicks()
+	{
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+	}
+
+	struct Buffer
+	{
+		const int64_t originTicks = nowTicks(); // event times are printed relative to the first trace call
+		std::atomic<uint64_t> nextTicket{ 0 };
+		Slot slots[Trace::CAPACITY];
+	};
+
+	Buffer& buffer()
+	{
+		static Buffer instance;
+		return instance;
+	}
+
+	const char* levelName(int level)
+	{
+		switch (level) {
+		case TRACE_LEVEL_ERROR: return "ERROR";
+		case TRACE_LEVEL_INFO: return "INFO";
+		default: return "VERBOSE";
+		}
+	}
+
+	void writeEvent(std::ostream& out, int64_t ticks, int level, const char* format, const int64_t* arguments)
+	{
+		const double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(ticks)).count();
+		out << "[" << static_cast<int64_t>(micros) << "us " << levelName(level) << "] ";
+
+		int next = 0;
+		for (const char* c = format; *c; c++) {
+			const bool decimal = std::strncmp(c, "{}", 2) == 0;
+			const bool hexadecimal = std::strncmp(c, "{x}", 3) == 0;
+			if ((decimal || hexadecimal) && next < Trace::MAX_ARGUMENTS) {
+				if (hexadecimal) {
+					out << "0x" << std::hex << static_cast<uint64_t>(arguments[next++]) << std::dec;
+					c += 2;
+				}
+				else {
+					out << arguments[next++];
+					c += 1;
+				}
+				continue;
+			}
+			out << *c;
+		}
+		out << "\n";
+	}
+}
+
+void Trace::record(Level level, const char* format, int64_t a, int64_t b, int64_t c, int64_t d)
+{
+	Buffer& ring = buffer();
+	const uint64_t ticket = ring.nextTicket.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = ring.slots[ticket & (CAPACITY - 1)];
+
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.ticks.store(nowTicks(), std::memory_order_relaxed);
+	slot.level.store(static_cast<int>(level), std::memory_order_relaxed);
+	slot.format.store(format, std::memory_order_relaxed);
+	slot.arguments[0].store(a, std::memory_order_relaxed);
+	slot.arguments[1].store(b, std::memory_order_relaxed);
+	slot.arguments[2].store(c, std::memory_order_relaxed);
+	slot.arguments[3].store(d, std::memory_order_relaxed);
+	slot.sequence.store(ticket + 1, std::memory_order_release);
+}
+
+void Trace::dump(std::ostream& out)
+{
+	Buffer& ring = buffer();
+	const uint64_t end = ring.nextTicket.load(std::memory_order_acquire);
+	const uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+
+	for (uint64_t ticket = begin; ticket < end; ticket++) {
+		const Slot& slot = ring.slots[ticket & (CAPACITY - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != ticket + 1) {
+			continue;
+		}
+		const int64_t ticks = slot.ticks.load(std::memory_order_relaxed);
+		const int level = slot.level.load(std::memory_order_relaxed);
+		const char* format = slot.format.load(std::memory_order_relaxed);
+		int64_t arguments[MAX_ARGUMENTS];
+		for (int i = 0; i < MAX_ARGUMENTS; i++) {
+			arguments[i] = slot.arguments[i].load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != ticket + 1) {
+			continue; // overwritten while copying
+		}
+		writeEvent(out, ticks - ring.originTicks, level, format, arguments);
+	}
+}
+
+uint64_t Trace::recordedCount()
+{
+	return buffer().nextTicket.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+
+// Compile-time trace levels: trace points above TRACE_LEVEL are discarded by the compiler
+// (if constexpr), their arguments included. Define TRACE_LEVEL in the project settings to change it,
+// e.g. TRACE_LEVEL=3 to trace every solver node.
+#define TRACE_LEVEL_OFF 0
+#define TRACE_LEVEL_ERROR 1   // rejected input, rare
+#define TRACE_LEVEL_INFO 2    // one event per solve or game
+#define TRACE_LEVEL_VERBOSE 3 // one event per node, debugging only
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_ERROR
+#endif
+
+// Events go to a fixed in-memory ring buffer (the oldest are overwritten) and are only formatted
+// when dumped, so a trace point costs a few stores and no stream or lock.
+// An event is a static format string, where each "{}" takes the next argument in decimal and
+// each "{x}" in hexadecimal, and up to four integer arguments.
+namespace Trace
+{
+	// Not ERROR/INFO/VERBOSE: windows.h defines ERROR as a macro
+	enum class Level { Error = TRACE_LEVEL_ERROR, Info = TRACE_LEVEL_INFO, Verbose = TRACE_LEVEL_VERBOSE };
+
+	// Events kept, a power of two
+	const uint64_t CAPACITY = 4096;
+	const int MAX_ARGUMENTS = 4;
+
+	// Lock-free, callable from any thread; format must outlive the buffer (a string literal)
+	void record(Level level, const char* format, int64_t a = 0, int64_t b = 0, int64_t c = 0, int64_t d = 0);
+
+	// Writes the events still in the buffer, oldest first, one per line.
+	// Events overwritten or being written while dumping are skipped.
+	void dump(std::ostream& out);
+
+	// Events recorded since start, including the overwritten ones
+	uint64_t recordedCount();
+}
+
+// level is a Trace::Level enumerator name, e.g. TRACE(Info, "Solved in {} plies", distance)
+#define TRACE(level, ...) \
+	do { \
+		if constexpr (static_cast<int>(Trace::Level::level) <= TRACE_LEVEL) { \
+			Trace::record(Trace::Level::level, __VA_ARGS__); \
+		} \
+	} while (false)
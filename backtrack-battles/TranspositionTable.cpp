@@ -0,0 +1,113 @@
+#include "TranspositionTable.h"
+#include <new>
+
+TranspositionTable::TranspositionTable(size_t megabytes) : capacity(0), bucketMask(0)
+{
+	// Largest power of two number of buckets within the budget (at least one bucket)
+	const size_t budget = megabytes * 1024 * 1024;
+	size_t bucketCount = 1;
+	while (bucketCount * 2 * sizeof(Bucket) <= budget) {
+		bucketCount *= 2;
+	}
+
+	// Under memory pressure settle for a smaller table rather than failing
+	while (true) {
+		try {
+			buckets.reset(new Bucket[bucketCount]);
+			break;
+		}
+		catch (const std::bad_alloc&) {
+			if (bucketCount == 1) throw;
+			bucketCount /= 2;
+		}
+	}
+	capacity = bucketCount * BUCKET_SIZE;
+	bucketMask = bucketCount - 1;
+	clear();
+}
+
+uint64_t TranspositionTable::makeData(Result result, uint16_t move, int distance, uint64_t priority)
+{
+	if (priority > 0xFFFF) priority = 0xFFFF;
+	return static_cast<uint64_t>(result) | (static_cast<uint64_t>(move) << 2) |
+		(static_cast<uint64_t>(distance & 0xFF) << 18) | (priority << 48);
+}
+
+uint64_t TranspositionTable::makeProofData(uint32_t proof, uint32_t disproof, uint64_t priority)
+{
+	if (priority > 0xFFFF) priority = 0xFFFF;
+	if (proof > MAX_PROOF_NUMBER) proof = MAX_PROOF_NUMBER;
+	if (disproof > MAX_PROOF_NUMBER) disproof = MAX_PROOF_NUMBER;
+	return static_cast<uint64_t>(Result::UNKNOWN) | (static_cast<uint64_t>(proof) << 2) |
+		(static_cast<uint64_t>(disproof) << 25) | (priority << 48);
+}
+
+bool TranspositionTable::probe(uint64_t key, uint64_t& data)
+{
+	Entry* bucket = bucketFor(key);
+	for (int i = 0; i < BUCKET_SIZE; i++) {
+		const uint64_t entryData = bucket[i].data.load(std::memory_order_relaxed);
+		const uint64_t entryCheck = bucket[i].check.load(std::memory_order_relaxed);
+		if (entryData != 0 && (entryCheck ^ entryData) == key) {
+			data = entryData;
+			hits.increment();
+			return true;
+		}
+	}
+	misses.increment();
+	return false;
+}
+
+void TranspositionTable::store(uint64_t key, uint64_t data)
+{
+	Entry* bucket = bucketFor(key);
+	Entry* victim = &bucket[0];
+	uint64_t victimData = bucket[0].data.load(std::memory_order_relaxed);
+	bool sameKey = false;
+	for (int i = 0; i < BUCKET_SIZE; i++) {
+		const uint64_t entryData = bucket[i].data.load(std::memory_order_relaxed);
+		// Same position or a free slot: take it
+		if (entryData == 0 || (bucket[i].check.load(std::memory_order_relaxed) ^ entryData) == key) {
+			victim = &bucket[i];
+			victimData = entryData;
+			sameKey = entryData != 0;
+			break;
+		}
+		// Otherwise evict the entry that was cheapest to compute
+		if (priorityOf(entryData) < priorityOf(victimData)) {
+			victim = &bucket[i];
+			victimData = entryData;
+		}
+	}
+
+	if (victimData != 0 && !sameKey) {
+		overwrites.increment();
+	}
+	victim->check.store(key ^ data, std::memory_order_relaxed);
+	victim->data.store(data, std::memory_order_relaxed);
+	stores.increment();
+}
+
+void TranspositionTable::clear()
+{
+	for (size_t bucket = 0; bucket <= bucketMask; bucket++) {
+		for (Entry& entry : buckets[bucket].entries) {
+			entry.check.store(0, std::memory_order_relaxed);
+			entry.data.store(0, std::memory_order_relaxed);
+		}
+	}
+	hits.value.store(0, std::memory_order_relaxed);
+	misses.value.store(0, std::memory_order_relaxed);
+	stores.value.store(0, std::memory_order_relaxed);
+	overwrites.value.store(0, std::memory_order_relaxed);
+}
+
+TranspositionTable::Counters TranspositionTable::getCounters() const
+{
+	Counters result;
+	result.hits = hits.get();
+	result.misses = misses.get();
+	result.stores = stores.get();
+	result.overwrites = overwrites.get();
+	return result;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// Fixed-size, open-addressed cache of solved positions with a memory budget
+// The table is a power-of-two array of buckets (4 entries, one 64-byte cache line each).
+// An entry is a 64-bit key check plus a 64-bit payload; when a bucket is full the entry with the
+// lowest priority (smallest solved subtree) is overwritten, so a full table keeps working instead
+// of growing until the process runs out of memory.
+// The table can be shared by several solver threads without locks: an entry stores key ^ data
+// next to data, so a probe that races with a store sees a key mismatch and misses instead of
+// returning another position's result. Counters are approximate while threads share the table.
+class TranspositionTable
+{
+public:
+	static const int BUCKET_SIZE = 4;
+
+	// Result stored for the side to move
+	enum class Result { UNKNOWN = 0, WIN = 1, LOSS = 2 };
+
+	// Payload layout: bits 0-1 result, bits 2-17 best move (CompactMove bits),
+	// bits 18-25 distance (plies to the end of the game with best play),
+	// bits 48-63 replacement priority (saturated subtree size)
+	static uint64_t makeData(Result result, uint16_t move, int distance, uint64_t priority);
+	static Result resultOf(uint64_t data) { return static_cast<Result>(data & 0x3); }
+	static uint16_t moveOf(uint64_t data) { return static_cast<uint16_t>(data >> 2); }
+	static int distanceOf(uint64_t data) { return static_cast<int>((data >> 18) & 0xFF); }
+	static uint32_t priorityOf(uint64_t data) { return static_cast<uint32_t>(data >> 48); }
+
+	// Positions still being proven by DfpnSolver are stored with result UNKNOWN and their
+	// proof and disproof numbers in bits 2-24 and 25-47 (saturated at MAX_PROOF_NUMBER)
+	static const uint32_t MAX_PROOF_NUMBER = (1u << 23) - 1;
+	static uint64_t makeProofData(uint32_t proof, uint32_t disproof, uint64_t priority);
+	static uint32_t proofOf(uint64_t data) { return static_cast<uint32_t>(data >> 2) & MAX_PROOF_NUMBER; }
+	static uint32_t disproofOf(uint64_t data) { return static_cast<uint32_t>(data >> 25) & MAX_PROOF_NUMBER; }
+
+	struct Counters
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t stores = 0;
+		uint64_t overwrites = 0; // a different position was evicted
+	};
+
+	// Allocates the largest power-of-two number of buckets fitting in the budget,
+	// halving the request when the allocation fails
+	explicit TranspositionTable(size_t megabytes);
+
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+	bool probe(uint64_t key, uint64_t& data);
+	// Start loading the bucket of key into the cache, so several probes can overlap their misses
+	void prefetch(uint64_t key) const
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(reinterpret_cast<const char*>(bucketFor(key)), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(bucketFor(key));
+#endif
+	}
+	void store(uint64_t key, uint64_t data);
+	void clear();
+
+	size_t getCapacity() const { return capacity; }
+	size_t getMemoryBytes() const { return capacity * sizeof(Entry); }
+	Counters getCounters() const;
+
+private:
+	struct Entry
+	{
+		std::atomic<uint64_t> check; // key ^ data
+		std::atomic<uint64_t> data;  // 0 marks an empty slot (stored results are never 0)
+	};
+
+	// Aligned so that a probe (and a prefetch) touches exactly one cache line
+	struct alignas(64) Bucket
+	{
+		Entry entries[BUCKET_SIZE];
+	};
+	static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one 64-byte cache line");
+
+	// Relaxed load and store instead of an atomic add: no locked instruction on the probe path,
+	// at the price of losing a few increments when threads collide
+	struct Counter
+	{
+		std::atomic<uint64_t> value{ 0 };
+		void increment() { value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+		uint64_t get() const { return value.load(std::memory_order_relaxed); }
+	};
+
+	std::unique_ptr<Bucket[]> buckets; // over-aligned new (C++17)
+	size_t capacity;
+	uint64_t bucketMask;
+	Counter hits;
+	Counter misses;
+	Counter stores;
+	Counter overwrites;
+
+	Entry* bucketFor(uint64_t key) const { return buckets[key & bucketMask].entries; }
+};
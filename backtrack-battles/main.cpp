@@ -1,8 +1,16 @@
 ﻿#include <iostream>
 #include <sstream>
 #include <limits>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
 #include "GameState.h"
 #include "GameSolver.h"
+#include "ParallelSolver.h"
+#include "DfpnSolver.h"
+#include "LayeredSolver.h"
+#include "Trace.h"
+#include "CpuPlayer.h"
 #include "Menu.h"
 
 // Function declarations
@@ -13,8 +21,44 @@ void printTerminalHelp(int size);
 void clearTerminalInputBuffer();
 bool processTerminalCommand(GameState& state, const std::string& input);
 bool handleTerminalPlayerMove(GameState& state);
+bool handleTerminalCpuMove(GameState& state);
+void solveTerminalState(const GameState& state);
+
+// Transposition table budget of the solver in megabytes (--tt-mb N)
+static size_t solverTableMegabytes = GameSolver::DEFAULT_TT_MEGABYTES;
+// Worker threads of the solver (--threads N), 0 uses every hardware thread
+static int solverThreads = 0;
+// Solver used by the 'solve' command: parallel depth-first search by default,
+// df-pn (--dfpn) or the layered solver (--layered, spill files in --spill-dir DIR)
+enum class SolverMode { PARALLEL, DFPN, LAYERED };
+static SolverMode solverMode = SolverMode::PARALLEL;
+static std::string solverSpillDirectory = ".";
+// Print the parallel solver's statistics as JSON after 'solve' (--stats)
+static bool printSolverStats = false;
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--tt-mb" && i + 1 < argc) {
+            solverTableMegabytes = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            solverThreads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--dfpn") {
+            solverMode = SolverMode::DFPN;
+        }
+        else if (arg == "--layered") {
+            solverMode = SolverMode::LAYERED;
+        }
+        else if (arg == "--spill-dir" && i + 1 < argc) {
+            solverSpillDirectory = argv[++i];
+        }
+        else if (arg == "--stats") {
+            printSolverStats = true;
+        }
+    }
 
-int main() {
     std::cout << "=== TOKEN TACTICS ===\n";
     std::cout << "Select game mode:\n";
     std::cout << "1. Terminal Version (Text-based)\n";
@@ -57,6 +101,13 @@ void runTerminalVersion() {
     while (true) {
         printTerminalBoard(state);
 
+        if (state.getCurrentPlayer() == GameState::Player::PLAYER1) {
+            if (!handleTerminalCpuMove(state)) {
+                break;
+            }
+            continue;
+        }
+
         if (!handleTerminalPlayerMove(state)) {
             break;
         }
@@ -83,7 +134,9 @@ void printTerminalHelp(int size) {
     std::cout << "3. Player 2 (O) is Human (you)\n";
     std::cout << "4. Valid coordinates: 0-" << size - 1 << "\n";
     std::cout << "5. Type 'help' to show this message\n";
-    std::cout << "6. Type 'quit' to exit\n\n";
+    std::cout << "6. Type 'solve' to solve the current position\n";
+    std::cout << "7. Type 'trace' to print the recorded trace events\n";
+    std::cout << "8. Type 'quit' to exit\n\n";
 }
 
 void clearTerminalInputBuffer() {
@@ -100,6 +153,104 @@ bool processTerminalCommand(GameState& state, const std::string& input) {
         std::cout << "Game ended.\n";
         return false;
     }
+    if (input == "solve") {
+        solveTerminalState(state);
+        return true;
+    }
+    if (input == "trace") {
+        std::cout << Trace::recordedCount() << " trace events recorded (level " << TRACE_LEVEL << "):\n";
+        Trace::dump(std::cout);
+        return true;
+    }
+    return true;
+}
+
+void solveTerminalState(const GameState& state) {
+    const int components = state.countInteractionComponents();
+    if (components == 0) {
+        std::cout << "The armies have disengaged, the rest of the game is a pure race.\n";
+    }
+    else if (components > 1) {
+        std::cout << "Tokens form " << components << " groups that can no longer interact with each other.\n";
+    }
+
+    if (solverMode == SolverMode::LAYERED) {
+        LayeredSolver solver(state, solverSpillDirectory);
+        bool isGood;
+        try {
+            isGood = solver.solve();
+        }
+        catch (const std::runtime_error& error) {
+            std::cout << "Layered solver failed: " << error.what() << "\n";
+            return;
+        }
+        std::cout << "Side to move " << (isGood ? "wins" : "loses") << " with perfect play, game over in "
+            << solver.getDistance() << " plies (" << solver.getPositionCount() << " positions in "
+            << solver.getLayerCount() << " layers, widest " << solver.getWidestLayer() << ", at most "
+            << solver.getPeakResidentPositions() << " in memory).\n";
+
+        GameState::Move best = solver.getBestMove().second;
+        if (best.fromRow >= 0) {
+            std::cout << "Best move: " << best.fromRow << " " << best.fromCol
+                << " " << best.toRow << " " << best.toCol << "\n";
+        }
+        return;
+    }
+
+    if (solverMode == SolverMode::DFPN) {
+        DfpnSolver solver(state, solverTableMegabytes);
+        bool isGood = solver.solve();
+        std::cout << "Side to move " << (isGood ? "wins" : "loses") << " with perfect play, game over in "
+            << solver.getDistance() << " plies along the proof found (df-pn, " << solver.getNodesExpanded()
+            << " nodes expanded, " << solver.getReExpansions() << " re-expansions).\n";
+
+        GameState::Move best = solver.getBestMove().second;
+        if (best.fromRow >= 0) {
+            std::cout << "Best move: " << best.fromRow << " " << best.fromCol
+                << " " << best.toRow << " " << best.toCol << "\n";
+        }
+
+        TranspositionTable::Counters counters = solver.getTableCounters();
+        std::cout << "Table: " << counters.hits << " hits, " << counters.misses << " misses, "
+            << counters.stores << " stores, " << counters.overwrites << " overwrites\n";
+        return;
+    }
+
+    ParallelSolver solver(state, solverThreads, solverTableMegabytes);
+    bool isGood = solver.solve();
+    std::cout << "Side to move " << (isGood ? "wins" : "loses") << " with perfect play, game over in "
+        << solver.getDistance() << " plies along the line found (" << solver.getThreadCount() << " threads).\n";
+
+    GameState::Move best = solver.getBestMove().second;
+    if (best.fromRow >= 0) {
+        std::cout << "Best move: " << best.fromRow << " " << best.fromCol
+            << " " << best.toRow << " " << best.toCol << "\n";
+    }
+
+    TranspositionTable::Counters counters = solver.getTableCounters();
+    std::cout << "Table: " << counters.hits << " hits, " << counters.misses << " misses, "
+        << counters.stores << " stores, " << counters.overwrites << " overwrites\n";
+    if (printSolverStats) {
+        std::cout << "Stats: " << solver.getStats().toJson() << "\n";
+    }
+}
+
+bool handleTerminalCpuMove(GameState& state) {
+    GameState::Move move = CpuPlayer::chooseMove(state);
+    if (move.fromRow == -1) {
+        std::cout << "Player 1 (CPU) has no move left. Player 2 (Human) wins!\n";
+        return false;
+    }
+
+    std::cout << "Player 1 (CPU) plays: " << move.fromRow << " " << move.fromCol
+        << " " << move.toRow << " " << move.toCol << "\n";
+    state = state.applyMove(move);
+
+    if (state.isWinningForPlayer(GameState::Player::PLAYER1)) {
+        printTerminalBoard(state);
+        std::cout << "Player 1 (CPU) wins!\n";
+        return false;
+    }
     return true;
 }
 
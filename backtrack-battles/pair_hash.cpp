@@ -1,10 +0,0 @@
-#include <functional>
-#include <utility>
-using namespace std;
-
-struct pair_hash {
-    template <typename T1, typename T2>
-    size_t operator()(const pair<T1, T2>& p) const {
-        return hash<T1>()(p.first) ^ (hash<T2>()(p.second) << 1);
-    }
-};
\ No newline at end of file
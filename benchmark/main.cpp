@@ -0,0 +1,347 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <functional>
+#include "GameState.h"
+#include "GameSolver.h"
+#include "TranspositionTable.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Engine benchmarks: micro-benchmarks of the GameState primitives and timed GameSolver solves,
+// written as one JSON document so that runs of two engine versions can be compared.
+// usage: benchmark [--quick] [--label NAME] [--output FILE]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Each measurement repeats its work until it has run at least this long
+    double minSeconds = 0.5;
+
+    // Results are folded into this so the compiler cannot drop the measured work
+    volatile uint64_t sink = 0;
+
+    uint64_t peakResidentBytes() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.PeakWorkingSetSize;
+        }
+        return 0;
+#else
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+#endif
+    }
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // xorshift64, so the positions are the same on every compiler and platform
+    struct Random {
+        uint64_t state;
+        explicit Random(uint64_t seed) : state(seed) {}
+        uint64_t next() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+    };
+
+    // Position reached after plies random moves from the start, with the game still going
+    // (false if it ends before, or if the side to move is then home or blocked)
+    bool randomPosition(int size, int plies, Random& random, GameState& out) {
+        GameState state(size);
+        GameState::MoveList moves;
+        for (int ply = 0; ; ply++) {
+            if (state.isWinningForPlayer(state.getCurrentPlayer()) || state.generateAllPossibleMoves(moves) == 0) {
+                return false;
+            }
+            if (ply == plies) {
+                out = state;
+                return true;
+            }
+            state.makeMove(moves[static_cast<int>(random.next() % moves.size())]);
+        }
+    }
+
+    // Fixed sample of non-terminal positions at every depth of the game, used by the micro-benchmarks
+    std::vector<GameState> samplePositions(int size, int count, uint64_t seed) {
+        Random random(seed);
+        std::vector<GameState> positions;
+        const int longestGame = 2 * (size - 2) * (size - 1);
+        while (static_cast<int>(positions.size()) < count) {
+            GameState state(size);
+            if (randomPosition(size, static_cast<int>(random.next() % longestGame), random, state)) {
+                positions.push_back(state);
+            }
+        }
+        return positions;
+    }
+
+    struct MicroResult {
+        std::string name;
+        int size;
+        uint64_t operations;
+        double nanosecondsPerOperation;
+    };
+
+    // Runs pass (which performs opsPerPass operations) until minSeconds have elapsed
+    MicroResult runMicro(const std::string& name, int size, uint64_t opsPerPass, const std::function<uint64_t()>& pass) {
+        pass(); // warm-up
+        uint64_t operations = 0;
+        uint64_t folded = 0;
+        const Clock::time_point start = Clock::now();
+        double elapsed = 0;
+        do {
+            folded += pass();
+            operations += opsPerPass;
+            elapsed = secondsSince(start);
+        } while (elapsed < minSeconds);
+        sink = sink + folded;
+        std::cerr << "  " << name << " " << size << "x" << size << ": " << elapsed * 1e9 / operations << " ns/op\n";
+        return { name, size, operations, elapsed * 1e9 / operations };
+    }
+
+    void microBenchmarks(int size, std::vector<MicroResult>& results) {
+        const std::vector<GameState> positions = samplePositions(size, 512, 0x9E3779B97F4A7C15ULL + size);
+
+        // One legal move per position, plus the other move length along the same lane: a step is
+        // probed as a jump and a jump as a step, so the occupancy and jump checks are timed as well
+        std::vector<GameState::Move> legalMoves;
+        std::vector<GameState::Move> probeMoves;
+        for (const GameState& state : positions) {
+            GameState::MoveList moves;
+            state.generateAllPossibleMoves(moves);
+            const GameState::Move move = state.toMove(moves[0]);
+            legalMoves.push_back(move);
+            probeMoves.push_back(move);
+            const bool down = move.fromCol == move.toCol; // P1 moves down its column, P2 right along its row
+            const int length = (down ? move.toRow - move.fromRow : move.toCol - move.fromCol) == 1 ? 2 : 1;
+            probeMoves.push_back(down
+                ? GameState::Move(move.fromRow, move.fromCol, move.fromRow + length, move.fromCol)
+                : GameState::Move(move.fromRow, move.fromCol, move.fromRow, move.fromCol + length));
+        }
+        const uint64_t count = positions.size();
+
+        results.push_back(runMicro("generateAllPossibleMoves", size, count, [&]() {
+            uint64_t total = 0;
+            GameState::MoveList moves;
+            for (const GameState& state : positions) {
+                total += state.generateAllPossibleMoves(moves);
+            }
+            return total;
+        }));
+
+        results.push_back(runMicro("applyMove", size, count, [&]() {
+            uint64_t total = 0;
+            for (uint64_t i = 0; i < count; i++) {
+                total += positions[i].applyMove(legalMoves[i]).getZobristKey();
+            }
+            return total;
+        }));
+
+        results.push_back(runMicro("GameStateHash", size, count, [&]() {
+            uint64_t total = 0;
+            const GameState::GameStateHash hash;
+            for (const GameState& state : positions) {
+                total += hash(state);
+            }
+            return total;
+        }));
+
+        results.push_back(runMicro("isValidMove", size, probeMoves.size(), [&]() {
+            uint64_t total = 0;
+            for (size_t i = 0; i < probeMoves.size(); i++) {
+                total += positions[i / 2].isValidMove(probeMoves[i]);
+            }
+            return total;
+        }));
+
+        // Neighbouring positions differ, each state against itself matches: both outcomes are measured
+        results.push_back(runMicro("operator==", size, 2 * count, [&]() {
+            uint64_t total = 0;
+            for (uint64_t i = 0; i < count; i++) {
+                total += positions[i] == positions[(i + 1) % count];
+                total += positions[i] == positions[i];
+            }
+            return total;
+        }));
+    }
+
+    struct MacroResult {
+        std::string name;
+        int size;
+        int solves;
+        double secondsPerSolve;
+        uint64_t nodesExpanded; // per solve
+        double nodesPerSecond;
+        bool isGood;
+        int distance;
+        uint64_t peakResidentBytes; // process peak after this benchmark
+    };
+
+    // Sub-microsecond solves would otherwise spend minutes clearing the table between repetitions:
+    // they may stop early once the setup has taken this many times minSeconds, after MIN_SOLVES solves
+    const double SETUP_BUDGET_FACTOR = 4;
+    const int MIN_SOLVES = 1000;
+
+    // One table per benchmark, cleared before every repetition, and a fresh solver sharing it:
+    // only solve() is timed, and repetitions continue until minSeconds of solving have accumulated
+    MacroResult runSolve(const std::string& name, const GameState& state, size_t tableMegabytes) {
+        MacroResult result{ name, state.getSize(), 0, 0, 0, 0, false, 0, 0 };
+        TranspositionTable table(tableMegabytes);
+        double elapsed = 0;
+        const Clock::time_point wallStart = Clock::now();
+        do {
+            table.clear();
+            GameSolver solver(state, table);
+            const Clock::time_point start = Clock::now();
+            result.isGood = solver.solve();
+            elapsed += secondsSince(start);
+            result.nodesExpanded = solver.getNodesExpanded();
+            result.distance = solver.getDistance();
+            result.solves++;
+        } while (elapsed < minSeconds &&
+            (result.solves < MIN_SOLVES || secondsSince(wallStart) - elapsed < SETUP_BUDGET_FACTOR * minSeconds));
+
+        result.secondsPerSolve = elapsed / result.solves;
+        result.nodesPerSecond = result.secondsPerSolve > 0 ? result.nodesExpanded / result.secondsPerSolve : 0;
+        result.peakResidentBytes = peakResidentBytes();
+        std::cerr << "  " << name << ": " << result.secondsPerSolve * 1e3 << " ms, "
+            << result.nodesExpanded << " nodes, " << result.nodesPerSecond << " nodes/s\n";
+        return result;
+    }
+
+    // Mid-game suite: openings of random moves from fixed seeds, chosen so that each solve takes 10 ms to 1 s
+    struct MidGameSpec {
+        int size;
+        int plies;
+        uint64_t seed;
+    };
+    const MidGameSpec MID_GAME_SUITE[] = {
+        { 6, 2, 2 }, { 6, 4, 3 },
+        { 7, 6, 2 }, { 7, 6, 5 }, { 7, 12, 5 },
+        { 8, 24, 1 }, { 8, 24, 3 }, { 8, 30, 3 },
+    };
+
+    void macroBenchmarks(bool quick, std::vector<MacroResult>& results) {
+        const size_t tableMegabytes = GameSolver::DEFAULT_TT_MEGABYTES;
+        // Up to 5x5 the tree has less than a thousand nodes: a small table keeps clearing it cheap
+        // next to the thousands of repetitions these solves need
+        const size_t smallTableMegabytes = 1;
+        for (int size = 3; size <= 6; size++) {
+            results.push_back(runSolve("start-" + std::to_string(size), GameState(size),
+                size <= 5 ? smallTableMegabytes : tableMegabytes));
+        }
+        for (const MidGameSpec& spec : MID_GAME_SUITE) {
+            if (quick && spec.size > 6) {
+                continue;
+            }
+            // Seeds whose playout ends early are skipped deterministically
+            Random random(spec.seed);
+            GameState state(spec.size);
+            while (!randomPosition(spec.size, spec.plies, random, state)) {
+            }
+            results.push_back(runSolve("midgame-" + std::to_string(spec.size) + "-" + std::to_string(spec.plies)
+                + "-" + std::to_string(spec.seed), state, tableMegabytes));
+        }
+    }
+
+    std::string quoted(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    std::string toJson(const std::string& label, bool quick, const std::vector<MicroResult>& micro,
+        const std::vector<MacroResult>& macro, double totalSeconds) {
+        std::ostringstream json;
+        json << "{\n  \"label\": " << quoted(label) << ",\n  \"quick\": " << (quick ? "true" : "false")
+            << ",\n  \"totalSeconds\": " << totalSeconds
+            << ",\n  \"peakResidentBytes\": " << peakResidentBytes() << ",\n  \"micro\": [";
+        for (size_t i = 0; i < micro.size(); i++) {
+            const MicroResult& r = micro[i];
+            json << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << quoted(r.name) << ", \"size\": " << r.size
+                << ", \"operations\": " << r.operations << ", \"nsPerOp\": " << r.nanosecondsPerOperation << "}";
+        }
+        json << "\n  ],\n  \"macro\": [";
+        for (size_t i = 0; i < macro.size(); i++) {
+            const MacroResult& r = macro[i];
+            json << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << quoted(r.name) << ", \"size\": " << r.size
+                << ", \"solves\": " << r.solves << ", \"secondsPerSolve\": " << r.secondsPerSolve
+                << ", \"nodesExpanded\": " << r.nodesExpanded << ", \"nodesPerSecond\": " << r.nodesPerSecond
+                << ", \"isGood\": " << (r.isGood ? "true" : "false") << ", \"distance\": " << r.distance
+                << ", \"peakResidentBytes\": " << r.peakResidentBytes << "}";
+        }
+        json << "\n  ]\n}\n";
+        return json.str();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool quick = false;
+    std::string label = "benchmark";
+    std::string outputPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            quick = true;
+        }
+        else if (arg == "--label" && i + 1 < argc) {
+            label = argv[++i];
+        }
+        else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        }
+        else {
+            std::cerr << "usage: benchmark [--quick] [--label NAME] [--output FILE]\n";
+            return 1;
+        }
+    }
+    // Quick runs skip the 7x7 and 8x8 positions and shorten every measurement
+    if (quick) {
+        minSeconds = 0.1;
+    }
+
+    const Clock::time_point start = Clock::now();
+    std::vector<MicroResult> micro;
+    std::vector<MacroResult> macro;
+    std::cerr << "Micro-benchmarks\n";
+    for (int size : { 6, 8, 10 }) {
+        microBenchmarks(size, micro);
+    }
+    std::cerr << "Solver benchmarks\n";
+    macroBenchmarks(quick, macro);
+
+    const std::string json = toJson(label, quick, micro, macro, secondsSince(start));
+    if (outputPath.empty()) {
+        std::cout << json;
+        return 0;
+    }
+    std::ofstream file(outputPath);
+    file << json;
+    if (!file) {
+        std::cerr << "Cannot write " << outputPath << "\n";
+        return 1;
+    }
+    std::cerr << "Results written to " << outputPath << "\n";
+    return 0;
+}
@@ -0,0 +1,434 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include "GameState.h"
+#include "PackedState.h"
+
+// Move generation counter: walks every move sequence from a position and counts, for each ply,
+// the positions reached and the games that end there. Counts are exact, so they serve as regression
+// checksums for the move generator, and the walk doubles as a raw move generation benchmark.
+// A game ends where GameSolver stops: the side to move has all its tokens home, or has no move.
+// usage: perft <size> [depth | --full] [--moves "r c r c, r c r c, ..."] [--threads N] [--hash MB] [--reference]
+//        perft --verify [--threads N] [--hash MB] [--reference]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct DepthCounts {
+        uint64_t positions = 0;
+        uint64_t gameEnds = 0;
+
+        void add(const DepthCounts& other) {
+            positions += other.positions;
+            gameEnds += other.gameEnds;
+        }
+    };
+
+    // rows[ply] for ply 0 (the start position) to the requested depth
+    using Rows = std::vector<DepthCounts>;
+
+    bool isGameOver(const GameState& state, GameState::MoveList& moves) {
+        return state.isWinningForPlayer(state.getCurrentPlayer()) || state.generateAllPossibleMoves(moves) == 0;
+    }
+
+    // Default walk: allocation-free generator and in-place makeMove/unmakeMove, as used by the solvers
+    void countFast(GameState& state, int ply, int depth, Rows& rows) {
+        rows[ply].positions++;
+        GameState::MoveList moves;
+        if (isGameOver(state, moves)) {
+            rows[ply].gameEnds++;
+            return;
+        }
+        if (ply == depth) {
+            return;
+        }
+        for (const GameState::CompactMove& move : moves) {
+            const GameState::UndoInfo undo = state.makeMove(move);
+            countFast(state, ply + 1, depth, rows);
+            state.unmakeMove(move, undo);
+        }
+    }
+
+    // Reference generator, independent of the move generation kernels: every cell of the side to move
+    // is scanned and the step and the jump along its direction are kept if isValidMove accepts them
+    // (isValidMove reads the board cell by cell, it does not go through the kernels)
+    std::vector<GameState::Move> referenceMoves(const GameState& state) {
+        const bool player1 = state.getCurrentPlayer() == GameState::Player::PLAYER1;
+        const GameState::CellStatus own = player1 ? GameState::CellStatus::PLAYER_1 : GameState::CellStatus::PLAYER_2;
+        const int size = state.getSize();
+        std::vector<GameState::Move> moves;
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                if (state.getCellStatus(row, col) != own) {
+                    continue;
+                }
+                for (int distance = 1; distance <= 2; distance++) {
+                    const GameState::Move move(row, col, player1 ? row + distance : row, player1 ? col : col + distance);
+                    if (state.isValidMove(move)) {
+                        moves.push_back(move);
+                    }
+                }
+            }
+        }
+        return moves;
+    }
+
+    // Reference walk (--reference): the reference generator and the validating, copying applyMove,
+    // so the counts of the default walk are checked against code that shares nothing with its generator
+    void countReference(const GameState& state, int ply, int depth, Rows& rows) {
+        rows[ply].positions++;
+        const std::vector<GameState::Move> moves = referenceMoves(state);
+        if (state.isWinningForPlayer(state.getCurrentPlayer()) || moves.empty()) {
+            rows[ply].gameEnds++;
+            return;
+        }
+        if (ply == depth) {
+            return;
+        }
+        for (const GameState::Move& move : moves) {
+            countReference(state.applyMove(move), ply + 1, depth, rows);
+        }
+    }
+
+    // Cache of subtree counts (--hash): counts exactly `remaining` plies below a position.
+    // Entries hold the full position, so a hit is never a collision and the counts stay exact.
+    class CountTable {
+    public:
+        explicit CountTable(size_t megabytes) {
+            size_t count = 1;
+            while ((count * 2) * sizeof(Entry) <= megabytes * 1024 * 1024) {
+                count *= 2;
+            }
+            entries.resize(count);
+            mask = count - 1;
+        }
+
+        bool probe(const GameState& state, const PackedState& position, int remaining, DepthCounts& counts) const {
+            const Entry& entry = entries[indexOf(state, remaining)];
+            if (entry.remaining != remaining || entry.position.low != position.low || entry.position.high != position.high) {
+                return false;
+            }
+            counts = entry.counts;
+            return true;
+        }
+
+        // Always replaces
+        void store(const GameState& state, const PackedState& position, int remaining, const DepthCounts& counts) {
+            Entry& entry = entries[indexOf(state, remaining)];
+            entry.position = position;
+            entry.remaining = remaining;
+            entry.counts = counts;
+        }
+
+    private:
+        struct Entry {
+            PackedState position;
+            int remaining = -1; // -1 when empty
+            DepthCounts counts;
+        };
+
+        std::vector<Entry> entries;
+        size_t mask;
+
+        size_t indexOf(const GameState& state, int remaining) const {
+            return static_cast<size_t>((state.getZobristKey() ^ (remaining * 0x9E3779B97F4A7C15ULL)) & mask);
+        }
+    };
+
+    DepthCounts countHashed(GameState& state, int remaining, CountTable& table) {
+        DepthCounts counts;
+        GameState::MoveList moves;
+        const bool gameOver = isGameOver(state, moves);
+        if (remaining == 0) {
+            counts.positions = 1;
+            counts.gameEnds = gameOver ? 1 : 0;
+            return counts;
+        }
+        if (gameOver) {
+            return counts;
+        }
+
+        const PackedState position = state.toPackedState();
+        if (table.probe(state, position, remaining, counts)) {
+            return counts;
+        }
+        for (const GameState::CompactMove& move : moves) {
+            const GameState::UndoInfo undo = state.makeMove(move);
+            counts.add(countHashed(state, remaining - 1, table));
+            state.unmakeMove(move, undo);
+        }
+        table.store(state, position, remaining, counts);
+        return counts;
+    }
+
+    struct Options {
+        int depth = 0;
+        int threads = 1;
+        size_t hashMegabytes = 0; // 0: no cache
+        bool reference = false;
+    };
+
+    // Positions at splitPly are handed out to the workers, the plies above are counted here
+    // with the same generator as the workers
+    void collectFrontier(const GameState& state, int ply, int splitPly, bool reference, Rows& rows,
+        std::vector<GameState>& frontier) {
+        if (ply == splitPly) {
+            frontier.push_back(state);
+            return;
+        }
+        rows[ply].positions++;
+        if (reference) {
+            const std::vector<GameState::Move> moves = referenceMoves(state);
+            if (state.isWinningForPlayer(state.getCurrentPlayer()) || moves.empty()) {
+                rows[ply].gameEnds++;
+                return;
+            }
+            for (const GameState::Move& move : moves) {
+                collectFrontier(state.applyMove(move), ply + 1, splitPly, reference, rows, frontier);
+            }
+            return;
+        }
+
+        GameState::MoveList moves;
+        if (isGameOver(state, moves)) {
+            rows[ply].gameEnds++;
+            return;
+        }
+        GameState child(state);
+        for (const GameState::CompactMove& move : moves) {
+            const GameState::UndoInfo undo = child.makeMove(move);
+            collectFrontier(child, ply + 1, splitPly, reference, rows, frontier);
+            child.unmakeMove(move, undo);
+        }
+    }
+
+    Rows perft(const GameState& start, const Options& options) {
+        Rows rows(options.depth + 1);
+
+        // Two plies give every thread many subtrees to balance, a single thread takes the root whole
+        const int splitPly = options.threads > 1 ? std::min(2, options.depth) : 0;
+        std::vector<GameState> frontier;
+        collectFrontier(start, 0, splitPly, options.reference, rows, frontier);
+
+        std::atomic<size_t> next(0);
+        std::vector<Rows> workerRows(options.threads, Rows(options.depth + 1));
+        auto worker = [&](int index) {
+            Rows& local = workerRows[index];
+            std::unique_ptr<CountTable> table;
+            if (options.hashMegabytes > 0) {
+                table.reset(new CountTable(options.hashMegabytes / options.threads));
+            }
+            for (size_t item = next++; item < frontier.size(); item = next++) {
+                GameState state(frontier[item]);
+                if (table) {
+                    // One pass per ply, deeper passes reuse the shallower subtrees from the table
+                    for (int ply = splitPly; ply <= options.depth; ply++) {
+                        local[ply].add(countHashed(state, ply - splitPly, *table));
+                    }
+                }
+                else if (options.reference) {
+                    countReference(state, splitPly, options.depth, local);
+                }
+                else {
+                    countFast(state, splitPly, options.depth, local);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int i = 1; i < options.threads; i++) {
+            threads.emplace_back(worker, i);
+        }
+        worker(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (const Rows& local : workerRows) {
+            for (int ply = 0; ply <= options.depth; ply++) {
+                rows[ply].add(local[ply]);
+            }
+        }
+        return rows;
+    }
+
+    // Leaves: positions at the last ply plus the games that ended before it
+    uint64_t leafCount(const Rows& rows) {
+        uint64_t leaves = rows.back().positions;
+        for (size_t ply = 0; ply + 1 < rows.size(); ply++) {
+            leaves += rows[ply].gameEnds;
+        }
+        return leaves;
+    }
+
+    // Longest possible game: every token walks its whole lane one cell at a time
+    int longestGame(int size) {
+        return 2 * (size - 2) * (size - 1);
+    }
+
+    // Regression checksums from the start position: (size, depth, leaves, games ended within depth).
+    // 3x3 to 5x5 are complete game trees; on larger boards the first games end deeper (ply 16 on 6x6).
+    struct Checksum {
+        int size;
+        int depth;
+        uint64_t leaves;
+        uint64_t gameEnds;
+    };
+    const Checksum CHECKSUMS[] = {
+        { 3, 4, 1, 1 },
+        { 4, 12, 74, 74 },
+        { 5, 24, 21423784, 21423784 },
+        { 6, 12, 10317034, 0 },
+        { 7, 10, 7789330, 0 },
+        { 8, 9, 8981557, 0 },
+        { 9, 8, 5442357, 0 },
+        { 10, 8, 16116079, 0 },
+    };
+
+    uint64_t totalGameEnds(const Rows& rows) {
+        uint64_t total = 0;
+        for (const DepthCounts& row : rows) {
+            total += row.gameEnds;
+        }
+        return total;
+    }
+
+    // Runs the checksums with the walk selected by the options (threads, cache, reference generator)
+    int verify(Options options) {
+        int failures = 0;
+        for (const Checksum& checksum : CHECKSUMS) {
+            options.depth = checksum.depth;
+            const Rows rows = perft(GameState(checksum.size), options);
+            const bool passed = leafCount(rows) == checksum.leaves && totalGameEnds(rows) == checksum.gameEnds;
+            failures += passed ? 0 : 1;
+            std::cout << (passed ? "[PASS] " : "[FAIL] ") << checksum.size << "x" << checksum.size
+                << " depth " << checksum.depth << ": " << leafCount(rows) << " leaves, "
+                << totalGameEnds(rows) << " game ends";
+            if (!passed) {
+                std::cout << " (expected " << checksum.leaves << ", " << checksum.gameEnds << ")";
+            }
+            std::cout << "\n";
+        }
+        return failures == 0 ? 0 : 1;
+    }
+
+    // Moves as "fromRow fromCol toRow toCol", separated by commas, applied with validation
+    GameState applyMoves(GameState state, const std::string& text) {
+        std::stringstream list(text);
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            std::istringstream fields(item);
+            GameState::Move move(-1, -1, -1, -1);
+            if (!(fields >> move.fromRow >> move.fromCol >> move.toRow >> move.toCol)) {
+                throw std::invalid_argument("Cannot read move '" + item + "'");
+            }
+            if (!state.isValidMove(move)) {
+                throw std::invalid_argument("Invalid move '" + item + "'");
+            }
+            state = state.applyMove(move);
+        }
+        return state;
+    }
+
+    void printUsage() {
+        std::cerr << "usage: perft <size> [depth | --full] [--moves \"r c r c, ...\"] [--threads N] [--hash MB] [--reference]\n"
+            << "       perft --verify [--threads N] [--hash MB] [--reference]\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int size = 0;
+    Options options;
+    options.depth = -1;
+    bool full = false;
+    bool verifyMode = false;
+    std::string moves;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--full") {
+            full = true;
+        }
+        else if (arg == "--verify") {
+            verifyMode = true;
+        }
+        else if (arg == "--reference") {
+            options.reference = true;
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--hash" && i + 1 < argc) {
+            options.hashMegabytes = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--moves" && i + 1 < argc) {
+            moves = argv[++i];
+        }
+        else if (size == 0) {
+            size = std::atoi(argv[i]);
+        }
+        else if (options.depth < 0) {
+            options.depth = std::atoi(argv[i]);
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // The cache is only wired into the default walk
+    if (options.reference && options.hashMegabytes > 0) {
+        printUsage();
+        return 1;
+    }
+    if (verifyMode) {
+        return verify(options);
+    }
+    if (size == 0 || (options.depth < 0 && !full)) {
+        printUsage();
+        return 1;
+    }
+
+    try {
+        const GameState start = applyMoves(GameState(size), moves);
+        // Every move advances a token, so no game is longer than this
+        if (full || options.depth > longestGame(size)) {
+            options.depth = longestGame(size);
+        }
+
+        const Clock::time_point begin = Clock::now();
+        const Rows rows = perft(start, options);
+        const double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        uint64_t total = 0;
+        std::cout << "ply  positions  game ends\n";
+        for (int ply = 0; ply <= options.depth; ply++) {
+            total += rows[ply].positions;
+            if (full && rows[ply].positions == 0) {
+                break;
+            }
+            std::cout << ply << "  " << rows[ply].positions << "  " << rows[ply].gameEnds << "\n";
+        }
+        std::cout << "Leaves: " << leafCount(rows) << ", games ended: " << totalGameEnds(rows) << "\n";
+        std::cout << "Time: " << seconds << "s";
+        // The cached walk skips subtrees, its rate is not a move generation rate
+        if (options.hashMegabytes == 0 && seconds > 0) {
+            std::cout << ", " << static_cast<uint64_t>(total / seconds) << " positions/s";
+        }
+        std::cout << " (" << options.threads << " threads" << (options.hashMegabytes > 0 ? ", hashed" : "")
+            << (options.reference ? ", reference generator" : "") << ")\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include "Tablebase.h"
+
+// Offline generator: solves every position of one board size and writes the result file
+// usage: tablebase <size> [output file] [--distance]
+int main(int argc, char* argv[]) {
+    int size = 0;
+    std::string path;
+    bool withDistance = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--distance") {
+            withDistance = true;
+        }
+        else if (size == 0) {
+            size = std::atoi(argv[i]);
+        }
+        else {
+            path = arg;
+        }
+    }
+
+    if (size == 0) {
+        std::cerr << "usage: tablebase <size 3-" << Tablebase::MAX_TABLEBASE_SIZE << "> [output file] [--distance]\n";
+        return 1;
+    }
+    if (path.empty()) {
+        path = "tablebase-" + std::to_string(size) + ".bin";
+    }
+
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        std::cout << "Generating " << size << "x" << size << ": "
+            << Tablebase::positionCount(size) << " positions"
+            << (withDistance ? " with distances" : "") << "\n";
+
+        auto progress = [](uint64_t done, uint64_t total) {
+            std::cout << "\r" << (done * 100 / total) << "%" << std::flush;
+        };
+        std::vector<uint8_t> results = withDistance ? Tablebase::generateDistances(size, progress)
+            : Tablebase::generate(size, progress);
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const uint64_t startIndex = Tablebase::rank(GameState(size));
+        const bool startWins = withDistance ? Tablebase::isWinEntry(results[startIndex]) : Tablebase::isWin(results, startIndex);
+        std::cout << "\rSolved in " << seconds << "s, Player 1 "
+            << (startWins ? "wins" : "loses") << " from the start position";
+        if (withDistance) {
+            std::cout << " in " << Tablebase::distanceOf(results[startIndex]) << " plies";
+        }
+        std::cout << "\n";
+
+        Tablebase::writeFile(path, size, results, withDistance ? Tablebase::Format::DISTANCE : Tablebase::Format::WIN_LOSS);
+        std::cout << "Wrote " << path << " (" << Tablebase::HEADER_BYTES + results.size() << " bytes)\n";
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}